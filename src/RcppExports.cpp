@@ -6,14 +6,26 @@
 
 using namespace Rcpp;
 
+// kernel_threads
+IntegerVector kernel_threads(int n_threads, int min_persons);
+RcppExport SEXP _FAIG_kernel_threads(SEXP n_threadsSEXP, SEXP min_personsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< int >::type n_threads(n_threadsSEXP);
+    Rcpp::traits::input_parameter< int >::type min_persons(min_personsSEXP);
+    rcpp_result_gen = Rcpp::wrap(kernel_threads(n_threads, min_persons));
+    return rcpp_result_gen;
+END_RCPP
+}
 // get_valmat
-arma::mat get_valmat(arma::mat vals, arma::ivec alloc, int n_items, int n_persons);
+arma::mat get_valmat(const arma::mat& vals, const arma::ivec& alloc, int n_items, int n_persons);
 RcppExport SEXP _FAIG_get_valmat(SEXP valsSEXP, SEXP allocSEXP, SEXP n_itemsSEXP, SEXP n_personsSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
-    Rcpp::traits::input_parameter< arma::mat >::type vals(valsSEXP);
-    Rcpp::traits::input_parameter< arma::ivec >::type alloc(allocSEXP);
+    Rcpp::traits::input_parameter< const arma::mat& >::type vals(valsSEXP);
+    Rcpp::traits::input_parameter< const arma::ivec& >::type alloc(allocSEXP);
     Rcpp::traits::input_parameter< int >::type n_items(n_itemsSEXP);
     Rcpp::traits::input_parameter< int >::type n_persons(n_personsSEXP);
     rcpp_result_gen = Rcpp::wrap(get_valmat(vals, alloc, n_items, n_persons));
@@ -21,38 +33,38 @@ BEGIN_RCPP
 END_RCPP
 }
 // get_maxenvy
-double get_maxenvy(arma::mat valmat, int n);
+double get_maxenvy(const arma::mat& valmat, int n);
 RcppExport SEXP _FAIG_get_maxenvy(SEXP valmatSEXP, SEXP nSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
-    Rcpp::traits::input_parameter< arma::mat >::type valmat(valmatSEXP);
+    Rcpp::traits::input_parameter< const arma::mat& >::type valmat(valmatSEXP);
     Rcpp::traits::input_parameter< int >::type n(nSEXP);
     rcpp_result_gen = Rcpp::wrap(get_maxenvy(valmat, n));
     return rcpp_result_gen;
 END_RCPP
 }
 // get_avgval
-arma::mat get_avgval(arma::mat valmat, int n);
+arma::mat get_avgval(const arma::mat& valmat, int n);
 RcppExport SEXP _FAIG_get_avgval(SEXP valmatSEXP, SEXP nSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
-    Rcpp::traits::input_parameter< arma::mat >::type valmat(valmatSEXP);
+    Rcpp::traits::input_parameter< const arma::mat& >::type valmat(valmatSEXP);
     Rcpp::traits::input_parameter< int >::type n(nSEXP);
     rcpp_result_gen = Rcpp::wrap(get_avgval(valmat, n));
     return rcpp_result_gen;
 END_RCPP
 }
 // get_fnV
-double get_fnV(arma::mat valmat, int n, arma::mat avgval);
+double get_fnV(const arma::mat& valmat, int n, const arma::mat& avgval);
 RcppExport SEXP _FAIG_get_fnV(SEXP valmatSEXP, SEXP nSEXP, SEXP avgvalSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
-    Rcpp::traits::input_parameter< arma::mat >::type valmat(valmatSEXP);
+    Rcpp::traits::input_parameter< const arma::mat& >::type valmat(valmatSEXP);
     Rcpp::traits::input_parameter< int >::type n(nSEXP);
-    Rcpp::traits::input_parameter< arma::mat >::type avgval(avgvalSEXP);
+    Rcpp::traits::input_parameter< const arma::mat& >::type avgval(avgvalSEXP);
     rcpp_result_gen = Rcpp::wrap(get_fnV(valmat, n, avgval));
     return rcpp_result_gen;
 END_RCPP
@@ -68,6 +80,120 @@ BEGIN_RCPP
     return rcpp_result_gen;
 END_RCPP
 }
+// get_objectives
+arma::vec get_objectives(const arma::mat& valmat, int n, const arma::mat& avgval);
+RcppExport SEXP _FAIG_get_objectives(SEXP valmatSEXP, SEXP nSEXP, SEXP avgvalSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< const arma::mat& >::type valmat(valmatSEXP);
+    Rcpp::traits::input_parameter< int >::type n(nSEXP);
+    Rcpp::traits::input_parameter< const arma::mat& >::type avgval(avgvalSEXP);
+    rcpp_result_gen = Rcpp::wrap(get_objectives(valmat, n, avgval));
+    return rcpp_result_gen;
+END_RCPP
+}
+// get_fnV_lb
+double get_fnV_lb(const arma::mat& vals, int n);
+RcppExport SEXP _FAIG_get_fnV_lb(SEXP valsSEXP, SEXP nSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< const arma::mat& >::type vals(valsSEXP);
+    Rcpp::traits::input_parameter< int >::type n(nSEXP);
+    rcpp_result_gen = Rcpp::wrap(get_fnV_lb(vals, n));
+    return rcpp_result_gen;
+END_RCPP
+}
+// get_maxenvy_lb
+double get_maxenvy_lb(const arma::mat& vals, int n);
+RcppExport SEXP _FAIG_get_maxenvy_lb(SEXP valsSEXP, SEXP nSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< const arma::mat& >::type vals(valsSEXP);
+    Rcpp::traits::input_parameter< int >::type n(nSEXP);
+    rcpp_result_gen = Rcpp::wrap(get_maxenvy_lb(vals, n));
+    return rcpp_result_gen;
+END_RCPP
+}
+// get_util_ub
+double get_util_ub(const arma::mat& vals, int n);
+RcppExport SEXP _FAIG_get_util_ub(SEXP valsSEXP, SEXP nSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< const arma::mat& >::type vals(valsSEXP);
+    Rcpp::traits::input_parameter< int >::type n(nSEXP);
+    rcpp_result_gen = Rcpp::wrap(get_util_ub(vals, n));
+    return rcpp_result_gen;
+END_RCPP
+}
+// roundrobin_alloc
+arma::ivec roundrobin_alloc(arma::mat vals);
+RcppExport SEXP _FAIG_roundrobin_alloc(SEXP valsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< arma::mat >::type vals(valsSEXP);
+    rcpp_result_gen = Rcpp::wrap(roundrobin_alloc(vals));
+    return rcpp_result_gen;
+END_RCPP
+}
+// envycycle_alloc
+arma::ivec envycycle_alloc(arma::mat vals);
+RcppExport SEXP _FAIG_envycycle_alloc(SEXP valsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< arma::mat >::type vals(valsSEXP);
+    rcpp_result_gen = Rcpp::wrap(envycycle_alloc(vals));
+    return rcpp_result_gen;
+END_RCPP
+}
+// greedysoc_alloc
+arma::ivec greedysoc_alloc(arma::mat vals);
+RcppExport SEXP _FAIG_greedysoc_alloc(SEXP valsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< arma::mat >::type vals(valsSEXP);
+    rcpp_result_gen = Rcpp::wrap(greedysoc_alloc(vals));
+    return rcpp_result_gen;
+END_RCPP
+}
+// greedyutil_alloc
+arma::ivec greedyutil_alloc(arma::mat vals);
+RcppExport SEXP _FAIG_greedyutil_alloc(SEXP valsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< arma::mat >::type vals(valsSEXP);
+    rcpp_result_gen = Rcpp::wrap(greedyutil_alloc(vals));
+    return rcpp_result_gen;
+END_RCPP
+}
+// islands
+List islands(arma::mat vals, const arma::ivec& alloc, int obj, int n_islands, int n_threads, int migrate, int maxiter, int maxnoimprove, double eps, double reltol, bool compact);
+RcppExport SEXP _FAIG_islands(SEXP valsSEXP, SEXP allocSEXP, SEXP objSEXP, SEXP n_islandsSEXP, SEXP n_threadsSEXP, SEXP migrateSEXP, SEXP maxiterSEXP, SEXP maxnoimproveSEXP, SEXP epsSEXP, SEXP reltolSEXP, SEXP compactSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< arma::mat >::type vals(valsSEXP);
+    Rcpp::traits::input_parameter< const arma::ivec& >::type alloc(allocSEXP);
+    Rcpp::traits::input_parameter< int >::type obj(objSEXP);
+    Rcpp::traits::input_parameter< int >::type n_islands(n_islandsSEXP);
+    Rcpp::traits::input_parameter< int >::type n_threads(n_threadsSEXP);
+    Rcpp::traits::input_parameter< int >::type migrate(migrateSEXP);
+    Rcpp::traits::input_parameter< int >::type maxiter(maxiterSEXP);
+    Rcpp::traits::input_parameter< int >::type maxnoimprove(maxnoimproveSEXP);
+    Rcpp::traits::input_parameter< double >::type eps(epsSEXP);
+    Rcpp::traits::input_parameter< double >::type reltol(reltolSEXP);
+    Rcpp::traits::input_parameter< bool >::type compact(compactSEXP);
+    rcpp_result_gen = Rcpp::wrap(islands(vals, alloc, obj, n_islands, n_threads, migrate, maxiter, maxnoimprove, eps, reltol, compact));
+    return rcpp_result_gen;
+END_RCPP
+}
 // testfunc
 int testfunc(int oldperson, int addperson, int n_persons);
 RcppExport SEXP _FAIG_testfunc(SEXP oldpersonSEXP, SEXP addpersonSEXP, SEXP n_personsSEXP) {
@@ -82,80 +208,139 @@ BEGIN_RCPP
 END_RCPP
 }
 // localtrades_envy
-List localtrades_envy(arma::mat vals, arma::ivec alloc, int maxiter, int maxnoimprove, double eps);
-RcppExport SEXP _FAIG_localtrades_envy(SEXP valsSEXP, SEXP allocSEXP, SEXP maxiterSEXP, SEXP maxnoimproveSEXP, SEXP epsSEXP) {
+List localtrades_envy(arma::mat vals, const arma::ivec& alloc, int maxiter, int maxnoimprove, double eps, double reltol, std::string checkpoint, int every, bool resume, bool compact);
+RcppExport SEXP _FAIG_localtrades_envy(SEXP valsSEXP, SEXP allocSEXP, SEXP maxiterSEXP, SEXP maxnoimproveSEXP, SEXP epsSEXP, SEXP reltolSEXP, SEXP checkpointSEXP, SEXP everySEXP, SEXP resumeSEXP, SEXP compactSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
     Rcpp::traits::input_parameter< arma::mat >::type vals(valsSEXP);
-    Rcpp::traits::input_parameter< arma::ivec >::type alloc(allocSEXP);
+    Rcpp::traits::input_parameter< const arma::ivec& >::type alloc(allocSEXP);
     Rcpp::traits::input_parameter< int >::type maxiter(maxiterSEXP);
     Rcpp::traits::input_parameter< int >::type maxnoimprove(maxnoimproveSEXP);
     Rcpp::traits::input_parameter< double >::type eps(epsSEXP);
-    rcpp_result_gen = Rcpp::wrap(localtrades_envy(vals, alloc, maxiter, maxnoimprove, eps));
+    Rcpp::traits::input_parameter< double >::type reltol(reltolSEXP);
+    Rcpp::traits::input_parameter< std::string >::type checkpoint(checkpointSEXP);
+    Rcpp::traits::input_parameter< int >::type every(everySEXP);
+    Rcpp::traits::input_parameter< bool >::type resume(resumeSEXP);
+    Rcpp::traits::input_parameter< bool >::type compact(compactSEXP);
+    rcpp_result_gen = Rcpp::wrap(localtrades_envy(vals, alloc, maxiter, maxnoimprove, eps, reltol, checkpoint, every, resume, compact));
     return rcpp_result_gen;
 END_RCPP
 }
 // localtrades_social
-List localtrades_social(arma::mat vals, arma::ivec alloc, int maxiter, int maxnoimprove, double eps);
-RcppExport SEXP _FAIG_localtrades_social(SEXP valsSEXP, SEXP allocSEXP, SEXP maxiterSEXP, SEXP maxnoimproveSEXP, SEXP epsSEXP) {
+List localtrades_social(arma::mat vals, const arma::ivec& alloc, int maxiter, int maxnoimprove, double eps, double reltol, std::string checkpoint, int every, bool resume, bool compact);
+RcppExport SEXP _FAIG_localtrades_social(SEXP valsSEXP, SEXP allocSEXP, SEXP maxiterSEXP, SEXP maxnoimproveSEXP, SEXP epsSEXP, SEXP reltolSEXP, SEXP checkpointSEXP, SEXP everySEXP, SEXP resumeSEXP, SEXP compactSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
     Rcpp::traits::input_parameter< arma::mat >::type vals(valsSEXP);
-    Rcpp::traits::input_parameter< arma::ivec >::type alloc(allocSEXP);
+    Rcpp::traits::input_parameter< const arma::ivec& >::type alloc(allocSEXP);
     Rcpp::traits::input_parameter< int >::type maxiter(maxiterSEXP);
     Rcpp::traits::input_parameter< int >::type maxnoimprove(maxnoimproveSEXP);
     Rcpp::traits::input_parameter< double >::type eps(epsSEXP);
-    rcpp_result_gen = Rcpp::wrap(localtrades_social(vals, alloc, maxiter, maxnoimprove, eps));
+    Rcpp::traits::input_parameter< double >::type reltol(reltolSEXP);
+    Rcpp::traits::input_parameter< std::string >::type checkpoint(checkpointSEXP);
+    Rcpp::traits::input_parameter< int >::type every(everySEXP);
+    Rcpp::traits::input_parameter< bool >::type resume(resumeSEXP);
+    Rcpp::traits::input_parameter< bool >::type compact(compactSEXP);
+    rcpp_result_gen = Rcpp::wrap(localtrades_social(vals, alloc, maxiter, maxnoimprove, eps, reltol, checkpoint, every, resume, compact));
     return rcpp_result_gen;
 END_RCPP
 }
 // localtrades_utility
-List localtrades_utility(arma::mat vals, arma::ivec alloc, int maxiter, int maxnoimprove, double eps);
-RcppExport SEXP _FAIG_localtrades_utility(SEXP valsSEXP, SEXP allocSEXP, SEXP maxiterSEXP, SEXP maxnoimproveSEXP, SEXP epsSEXP) {
+List localtrades_utility(arma::mat vals, const arma::ivec& alloc, int maxiter, int maxnoimprove, double eps, double reltol, std::string checkpoint, int every, bool resume, bool compact);
+RcppExport SEXP _FAIG_localtrades_utility(SEXP valsSEXP, SEXP allocSEXP, SEXP maxiterSEXP, SEXP maxnoimproveSEXP, SEXP epsSEXP, SEXP reltolSEXP, SEXP checkpointSEXP, SEXP everySEXP, SEXP resumeSEXP, SEXP compactSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
     Rcpp::traits::input_parameter< arma::mat >::type vals(valsSEXP);
-    Rcpp::traits::input_parameter< arma::ivec >::type alloc(allocSEXP);
+    Rcpp::traits::input_parameter< const arma::ivec& >::type alloc(allocSEXP);
     Rcpp::traits::input_parameter< int >::type maxiter(maxiterSEXP);
     Rcpp::traits::input_parameter< int >::type maxnoimprove(maxnoimproveSEXP);
     Rcpp::traits::input_parameter< double >::type eps(epsSEXP);
-    rcpp_result_gen = Rcpp::wrap(localtrades_utility(vals, alloc, maxiter, maxnoimprove, eps));
+    Rcpp::traits::input_parameter< double >::type reltol(reltolSEXP);
+    Rcpp::traits::input_parameter< std::string >::type checkpoint(checkpointSEXP);
+    Rcpp::traits::input_parameter< int >::type every(everySEXP);
+    Rcpp::traits::input_parameter< bool >::type resume(resumeSEXP);
+    Rcpp::traits::input_parameter< bool >::type compact(compactSEXP);
+    rcpp_result_gen = Rcpp::wrap(localtrades_utility(vals, alloc, maxiter, maxnoimprove, eps, reltol, checkpoint, every, resume, compact));
     return rcpp_result_gen;
 END_RCPP
 }
 // mincov
-List mincov(arma::mat vals, arma::ivec alloc, arma::mat beta, int maxiter, int maxnoimprove, double eps);
-RcppExport SEXP _FAIG_mincov(SEXP valsSEXP, SEXP allocSEXP, SEXP betaSEXP, SEXP maxiterSEXP, SEXP maxnoimproveSEXP, SEXP epsSEXP) {
+List mincov(const arma::mat& vals, const arma::ivec& alloc, int maxiter, int maxnoimprove, double eps, int sweep, double reltol, std::string checkpoint, int every, bool resume, bool compact);
+RcppExport SEXP _FAIG_mincov(SEXP valsSEXP, SEXP allocSEXP, SEXP maxiterSEXP, SEXP maxnoimproveSEXP, SEXP epsSEXP, SEXP sweepSEXP, SEXP reltolSEXP, SEXP checkpointSEXP, SEXP everySEXP, SEXP resumeSEXP, SEXP compactSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
-    Rcpp::traits::input_parameter< arma::mat >::type vals(valsSEXP);
-    Rcpp::traits::input_parameter< arma::ivec >::type alloc(allocSEXP);
-    Rcpp::traits::input_parameter< arma::mat >::type beta(betaSEXP);
+    Rcpp::traits::input_parameter< const arma::mat& >::type vals(valsSEXP);
+    Rcpp::traits::input_parameter< const arma::ivec& >::type alloc(allocSEXP);
     Rcpp::traits::input_parameter< int >::type maxiter(maxiterSEXP);
     Rcpp::traits::input_parameter< int >::type maxnoimprove(maxnoimproveSEXP);
     Rcpp::traits::input_parameter< double >::type eps(epsSEXP);
-    rcpp_result_gen = Rcpp::wrap(mincov(vals, alloc, beta, maxiter, maxnoimprove, eps));
+    Rcpp::traits::input_parameter< int >::type sweep(sweepSEXP);
+    Rcpp::traits::input_parameter< double >::type reltol(reltolSEXP);
+    Rcpp::traits::input_parameter< std::string >::type checkpoint(checkpointSEXP);
+    Rcpp::traits::input_parameter< int >::type every(everySEXP);
+    Rcpp::traits::input_parameter< bool >::type resume(resumeSEXP);
+    Rcpp::traits::input_parameter< bool >::type compact(compactSEXP);
+    rcpp_result_gen = Rcpp::wrap(mincov(vals, alloc, maxiter, maxnoimprove, eps, sweep, reltol, checkpoint, every, resume, compact));
     return rcpp_result_gen;
 END_RCPP
 }
 // mincovtarget
-List mincovtarget(arma::mat vals, arma::ivec alloc, arma::mat beta, arma::vec target, int maxiter, int maxnoimprove, double eps);
-RcppExport SEXP _FAIG_mincovtarget(SEXP valsSEXP, SEXP allocSEXP, SEXP betaSEXP, SEXP targetSEXP, SEXP maxiterSEXP, SEXP maxnoimproveSEXP, SEXP epsSEXP) {
+List mincovtarget(const arma::mat& vals, const arma::ivec& alloc, arma::vec target, int maxiter, int maxnoimprove, double eps, int sweep, double reltol, std::string checkpoint, int every, bool resume, bool compact);
+RcppExport SEXP _FAIG_mincovtarget(SEXP valsSEXP, SEXP allocSEXP, SEXP targetSEXP, SEXP maxiterSEXP, SEXP maxnoimproveSEXP, SEXP epsSEXP, SEXP sweepSEXP, SEXP reltolSEXP, SEXP checkpointSEXP, SEXP everySEXP, SEXP resumeSEXP, SEXP compactSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
-    Rcpp::traits::input_parameter< arma::mat >::type vals(valsSEXP);
-    Rcpp::traits::input_parameter< arma::ivec >::type alloc(allocSEXP);
-    Rcpp::traits::input_parameter< arma::mat >::type beta(betaSEXP);
+    Rcpp::traits::input_parameter< const arma::mat& >::type vals(valsSEXP);
+    Rcpp::traits::input_parameter< const arma::ivec& >::type alloc(allocSEXP);
     Rcpp::traits::input_parameter< arma::vec >::type target(targetSEXP);
     Rcpp::traits::input_parameter< int >::type maxiter(maxiterSEXP);
     Rcpp::traits::input_parameter< int >::type maxnoimprove(maxnoimproveSEXP);
     Rcpp::traits::input_parameter< double >::type eps(epsSEXP);
-    rcpp_result_gen = Rcpp::wrap(mincovtarget(vals, alloc, beta, target, maxiter, maxnoimprove, eps));
+    Rcpp::traits::input_parameter< int >::type sweep(sweepSEXP);
+    Rcpp::traits::input_parameter< double >::type reltol(reltolSEXP);
+    Rcpp::traits::input_parameter< std::string >::type checkpoint(checkpointSEXP);
+    Rcpp::traits::input_parameter< int >::type every(everySEXP);
+    Rcpp::traits::input_parameter< bool >::type resume(resumeSEXP);
+    Rcpp::traits::input_parameter< bool >::type compact(compactSEXP);
+    rcpp_result_gen = Rcpp::wrap(mincovtarget(vals, alloc, target, maxiter, maxnoimprove, eps, sweep, reltol, checkpoint, every, resume, compact));
+    return rcpp_result_gen;
+END_RCPP
+}
+// localtrades_pareto
+List localtrades_pareto(arma::mat vals, const arma::ivec& alloc, int archsize, int maxiter, int maxnoimprove);
+RcppExport SEXP _FAIG_localtrades_pareto(SEXP valsSEXP, SEXP allocSEXP, SEXP archsizeSEXP, SEXP maxiterSEXP, SEXP maxnoimproveSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< arma::mat >::type vals(valsSEXP);
+    Rcpp::traits::input_parameter< const arma::ivec& >::type alloc(allocSEXP);
+    Rcpp::traits::input_parameter< int >::type archsize(archsizeSEXP);
+    Rcpp::traits::input_parameter< int >::type maxiter(maxiterSEXP);
+    Rcpp::traits::input_parameter< int >::type maxnoimprove(maxnoimproveSEXP);
+    rcpp_result_gen = Rcpp::wrap(localtrades_pareto(vals, alloc, archsize, maxiter, maxnoimprove));
+    return rcpp_result_gen;
+END_RCPP
+}
+// localtrades_social_par
+List localtrades_social_par(arma::mat vals, const arma::ivec& alloc, int n_threads, int sync, int maxiter, int maxnoimprove, double eps, double reltol, bool compact);
+RcppExport SEXP _FAIG_localtrades_social_par(SEXP valsSEXP, SEXP allocSEXP, SEXP n_threadsSEXP, SEXP syncSEXP, SEXP maxiterSEXP, SEXP maxnoimproveSEXP, SEXP epsSEXP, SEXP reltolSEXP, SEXP compactSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< arma::mat >::type vals(valsSEXP);
+    Rcpp::traits::input_parameter< const arma::ivec& >::type alloc(allocSEXP);
+    Rcpp::traits::input_parameter< int >::type n_threads(n_threadsSEXP);
+    Rcpp::traits::input_parameter< int >::type sync(syncSEXP);
+    Rcpp::traits::input_parameter< int >::type maxiter(maxiterSEXP);
+    Rcpp::traits::input_parameter< int >::type maxnoimprove(maxnoimproveSEXP);
+    Rcpp::traits::input_parameter< double >::type eps(epsSEXP);
+    Rcpp::traits::input_parameter< double >::type reltol(reltolSEXP);
+    Rcpp::traits::input_parameter< bool >::type compact(compactSEXP);
+    rcpp_result_gen = Rcpp::wrap(localtrades_social_par(vals, alloc, n_threads, sync, maxiter, maxnoimprove, eps, reltol, compact));
     return rcpp_result_gen;
 END_RCPP
 }
@@ -172,49 +357,79 @@ BEGIN_RCPP
 END_RCPP
 }
 // randselect_envy
-List randselect_envy(arma::mat vals, int maxiter, int maxnoimprove, double eps);
-RcppExport SEXP _FAIG_randselect_envy(SEXP valsSEXP, SEXP maxiterSEXP, SEXP maxnoimproveSEXP, SEXP epsSEXP) {
+List randselect_envy(arma::mat vals, int walk, int maxiter, int maxnoimprove, double eps, double reltol, bool compact);
+RcppExport SEXP _FAIG_randselect_envy(SEXP valsSEXP, SEXP walkSEXP, SEXP maxiterSEXP, SEXP maxnoimproveSEXP, SEXP epsSEXP, SEXP reltolSEXP, SEXP compactSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
     Rcpp::traits::input_parameter< arma::mat >::type vals(valsSEXP);
+    Rcpp::traits::input_parameter< int >::type walk(walkSEXP);
     Rcpp::traits::input_parameter< int >::type maxiter(maxiterSEXP);
     Rcpp::traits::input_parameter< int >::type maxnoimprove(maxnoimproveSEXP);
     Rcpp::traits::input_parameter< double >::type eps(epsSEXP);
-    rcpp_result_gen = Rcpp::wrap(randselect_envy(vals, maxiter, maxnoimprove, eps));
+    Rcpp::traits::input_parameter< double >::type reltol(reltolSEXP);
+    Rcpp::traits::input_parameter< bool >::type compact(compactSEXP);
+    rcpp_result_gen = Rcpp::wrap(randselect_envy(vals, walk, maxiter, maxnoimprove, eps, reltol, compact));
     return rcpp_result_gen;
 END_RCPP
 }
 // randselect_social
-List randselect_social(arma::mat vals, int maxiter, int maxnoimprove, double eps);
-RcppExport SEXP _FAIG_randselect_social(SEXP valsSEXP, SEXP maxiterSEXP, SEXP maxnoimproveSEXP, SEXP epsSEXP) {
+List randselect_social(arma::mat vals, int walk, int maxiter, int maxnoimprove, double eps, double reltol, bool compact);
+RcppExport SEXP _FAIG_randselect_social(SEXP valsSEXP, SEXP walkSEXP, SEXP maxiterSEXP, SEXP maxnoimproveSEXP, SEXP epsSEXP, SEXP reltolSEXP, SEXP compactSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
     Rcpp::traits::input_parameter< arma::mat >::type vals(valsSEXP);
+    Rcpp::traits::input_parameter< int >::type walk(walkSEXP);
     Rcpp::traits::input_parameter< int >::type maxiter(maxiterSEXP);
     Rcpp::traits::input_parameter< int >::type maxnoimprove(maxnoimproveSEXP);
     Rcpp::traits::input_parameter< double >::type eps(epsSEXP);
-    rcpp_result_gen = Rcpp::wrap(randselect_social(vals, maxiter, maxnoimprove, eps));
+    Rcpp::traits::input_parameter< double >::type reltol(reltolSEXP);
+    Rcpp::traits::input_parameter< bool >::type compact(compactSEXP);
+    rcpp_result_gen = Rcpp::wrap(randselect_social(vals, walk, maxiter, maxnoimprove, eps, reltol, compact));
+    return rcpp_result_gen;
+END_RCPP
+}
+// simd_level
+std::string simd_level(int level);
+RcppExport SEXP _FAIG_simd_level(SEXP levelSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< int >::type level(levelSEXP);
+    rcpp_result_gen = Rcpp::wrap(simd_level(level));
     return rcpp_result_gen;
 END_RCPP
 }
 
 static const R_CallMethodDef CallEntries[] = {
+    {"_FAIG_kernel_threads", (DL_FUNC) &_FAIG_kernel_threads, 2},
     {"_FAIG_get_valmat", (DL_FUNC) &_FAIG_get_valmat, 4},
     {"_FAIG_get_maxenvy", (DL_FUNC) &_FAIG_get_maxenvy, 2},
     {"_FAIG_get_avgval", (DL_FUNC) &_FAIG_get_avgval, 2},
     {"_FAIG_get_fnV", (DL_FUNC) &_FAIG_get_fnV, 3},
     {"_FAIG_get_util", (DL_FUNC) &_FAIG_get_util, 1},
+    {"_FAIG_get_objectives", (DL_FUNC) &_FAIG_get_objectives, 3},
+    {"_FAIG_get_fnV_lb", (DL_FUNC) &_FAIG_get_fnV_lb, 2},
+    {"_FAIG_get_maxenvy_lb", (DL_FUNC) &_FAIG_get_maxenvy_lb, 2},
+    {"_FAIG_get_util_ub", (DL_FUNC) &_FAIG_get_util_ub, 2},
+    {"_FAIG_roundrobin_alloc", (DL_FUNC) &_FAIG_roundrobin_alloc, 1},
+    {"_FAIG_envycycle_alloc", (DL_FUNC) &_FAIG_envycycle_alloc, 1},
+    {"_FAIG_greedysoc_alloc", (DL_FUNC) &_FAIG_greedysoc_alloc, 1},
+    {"_FAIG_greedyutil_alloc", (DL_FUNC) &_FAIG_greedyutil_alloc, 1},
+    {"_FAIG_islands", (DL_FUNC) &_FAIG_islands, 11},
     {"_FAIG_testfunc", (DL_FUNC) &_FAIG_testfunc, 3},
-    {"_FAIG_localtrades_envy", (DL_FUNC) &_FAIG_localtrades_envy, 5},
-    {"_FAIG_localtrades_social", (DL_FUNC) &_FAIG_localtrades_social, 5},
-    {"_FAIG_localtrades_utility", (DL_FUNC) &_FAIG_localtrades_utility, 5},
-    {"_FAIG_mincov", (DL_FUNC) &_FAIG_mincov, 6},
-    {"_FAIG_mincovtarget", (DL_FUNC) &_FAIG_mincovtarget, 7},
+    {"_FAIG_localtrades_envy", (DL_FUNC) &_FAIG_localtrades_envy, 10},
+    {"_FAIG_localtrades_social", (DL_FUNC) &_FAIG_localtrades_social, 10},
+    {"_FAIG_localtrades_utility", (DL_FUNC) &_FAIG_localtrades_utility, 10},
+    {"_FAIG_mincov", (DL_FUNC) &_FAIG_mincov, 11},
+    {"_FAIG_mincovtarget", (DL_FUNC) &_FAIG_mincovtarget, 12},
+    {"_FAIG_localtrades_pareto", (DL_FUNC) &_FAIG_localtrades_pareto, 5},
+    {"_FAIG_localtrades_social_par", (DL_FUNC) &_FAIG_localtrades_social_par, 9},
     {"_FAIG_random_alloc", (DL_FUNC) &_FAIG_random_alloc, 2},
-    {"_FAIG_randselect_envy", (DL_FUNC) &_FAIG_randselect_envy, 4},
-    {"_FAIG_randselect_social", (DL_FUNC) &_FAIG_randselect_social, 4},
+    {"_FAIG_randselect_envy", (DL_FUNC) &_FAIG_randselect_envy, 7},
+    {"_FAIG_randselect_social", (DL_FUNC) &_FAIG_randselect_social, 7},
+    {"_FAIG_simd_level", (DL_FUNC) &_FAIG_simd_level, 1},
     {NULL, NULL, 0}
 };
 
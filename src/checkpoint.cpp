@@ -0,0 +1,145 @@
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#endif
+#include "RcppArmadillo.h"
+#include "checkpoint.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+
+
+// [[Rcpp::depends(RcppArmadillo)]]
+using namespace Rcpp;
+
+
+// layout of a checkpoint file: magic, version and solver, the sizes (alloc, rows and columns of
+// valmat, aux, seed), iter and noimprove as 32-bit integers, followed by obj, alloc, valmat,
+// valcomp, aux and seed, all in the byte order of the machine that wrote it
+static const char magic[8] = {'F', 'A', 'I', 'G', 'C', 'K', 'P', 'T'};
+static const int32_t version = 2;
+
+
+void write_ints(std::ofstream& f, const std::vector<int32_t>& x) {
+  f.write(reinterpret_cast<const char*>(x.data()), x.size() * sizeof(int32_t));
+}
+
+
+std::vector<int32_t> read_ints(std::ifstream& f, int n) {
+  std::vector<int32_t> x(std::max(n, 0));
+  f.read(reinterpret_cast<char*>(x.data()), x.size() * sizeof(int32_t));
+  return x;
+}
+
+
+void write_checkpoint(std::string file, int solver, const CheckpointState& state,
+                      std::atomic<bool>& writing, std::atomic<bool>& failed) {
+  // writes the state to a temporary file and moves it over the checkpoint - runs in the background
+  // and does not touch R
+  std::string tmp = file + ".tmp";
+  std::ofstream f(tmp.c_str(), std::ios::binary | std::ios::trunc);
+  std::vector<int32_t> header = {version, solver, (int32_t) state.alloc.n_elem,
+                                 (int32_t) state.valmat.n_rows, (int32_t) state.valmat.n_cols,
+                                 (int32_t) state.aux.n_elem, (int32_t) state.seed.size(),
+                                 state.iter, state.noimprove};
+  f.write(magic, sizeof(magic));
+  write_ints(f, header);
+  f.write(reinterpret_cast<const char*>(&state.obj), sizeof(double));
+  write_ints(f, std::vector<int32_t>(state.alloc.begin(), state.alloc.end()));
+  f.write(reinterpret_cast<const char*>(state.valmat.memptr()), state.valmat.n_elem * sizeof(double));
+  f.write(reinterpret_cast<const char*>(state.valcomp.memptr()), state.valcomp.n_elem * sizeof(double));
+  write_ints(f, std::vector<int32_t>(state.aux.begin(), state.aux.end()));
+  write_ints(f, std::vector<int32_t>(state.seed.begin(), state.seed.end()));
+  f.close();
+
+  bool ok = !f.fail();
+#ifdef _WIN32
+  // rename does not replace an existing file on Windows, MoveFileEx does so atomically
+  if (ok) ok = MoveFileExA(tmp.c_str(), file.c_str(),
+                           MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+  if (ok) ok = std::rename(tmp.c_str(), file.c_str()) == 0;
+#endif
+  if (!ok) failed = true;
+  writing = false;
+}
+
+
+Checkpoint::Checkpoint(std::string file, int every, bool resume, int solver)
+  : file(file), every(file.empty() ? 0 : every), resume(resume), solver(solver), writing(false),
+    failed(false) {
+}
+
+
+Checkpoint::~Checkpoint() {
+  if (writer.joinable()) writer.join();
+}
+
+
+void Checkpoint::save(CheckpointState state) {
+  // hands a copy of the state to the writer, together with the current state of the random number
+  // generator of R - if the previous checkpoint is still being written, this one is skipped rather
+  // than waiting for it
+  if (writing) return;
+  if (writer.joinable()) writer.join();
+
+  PutRNGstate();
+  IntegerVector seed = Environment::global_env()[".Random.seed"];
+  state.seed.assign(seed.begin(), seed.end());
+
+  writing = true;
+  writer = std::thread(write_checkpoint, file, solver, std::move(state), std::ref(writing),
+                       std::ref(failed));
+}
+
+
+bool Checkpoint::load(CheckpointState& state, int maxiter) {
+  // overwrites state with the checkpoint and restores the random number generator of R, if resuming
+  // from an existing checkpoint - the sizes of alloc, valmat and aux in state are checked against it,
+  // and it must not be beyond maxiter iterations
+  if (!resume || file.empty()) return false;
+  std::ifstream f(file.c_str(), std::ios::binary);
+  if (!f.is_open()) return false;
+
+  char m[8];
+  f.read(m, sizeof(m));
+  std::vector<int32_t> header = read_ints(f, 9);
+  if (!f || !std::equal(m, m + 8, magic) || header[0] != version) {
+    stop("'" + file + "' is not a checkpoint file.");
+  }
+  if (header[1] != solver || header[2] != (int) state.alloc.n_elem ||
+      header[3] != (int) state.valmat.n_rows || header[4] != (int) state.valmat.n_cols ||
+      header[5] != (int) state.aux.n_elem) {
+    stop("Checkpoint '" + file + "' was written by a different solver or problem.");
+  }
+  if (header[7] > maxiter) stop("Checkpoint '" + file + "' is beyond maxiter.");
+
+  state.iter = header[7];
+  state.noimprove = header[8];
+  f.read(reinterpret_cast<char*>(&state.obj), sizeof(double));
+  std::vector<int32_t> alloc = read_ints(f, header[2]);
+  f.read(reinterpret_cast<char*>(state.valmat.memptr()), state.valmat.n_elem * sizeof(double));
+  state.valcomp.set_size(state.valmat.n_rows, state.valmat.n_cols);
+  f.read(reinterpret_cast<char*>(state.valcomp.memptr()), state.valcomp.n_elem * sizeof(double));
+  std::vector<int32_t> aux = read_ints(f, header[5]);
+  std::vector<int32_t> seed = read_ints(f, header[6]);
+  if (!f) stop("Checkpoint '" + file + "' is truncated.");
+  for (int ii = 0; ii < header[2]; ii++) state.alloc(ii) = alloc[ii];
+  for (int ii = 0; ii < header[5]; ii++) state.aux(ii) = aux[ii];
+  state.seed.assign(seed.begin(), seed.end());
+
+  IntegerVector rseed(seed.begin(), seed.end());
+  Environment::global_env().assign(".Random.seed", rseed);
+  GetRNGstate();
+
+  return true;
+}
+
+
+void Checkpoint::finish() {
+  // waits for the last checkpoint to be written
+  if (writer.joinable()) writer.join();
+  if (failed) warning("Checkpoint could not be written to '" + file + "'.");
+}
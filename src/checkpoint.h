@@ -0,0 +1,53 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include "RcppArmadillo.h"
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+// [[Rcpp::depends(RcppArmadillo)]]
+using namespace Rcpp;
+
+
+struct CheckpointState {
+  // state of a solver from which it continues exactly as if it was not interrupted
+  arma::ivec alloc;                               // index of the person to which each item belongs
+  arma::mat valmat;                               // valuation state of the solver
+  arma::mat valcomp;                              // rounding errors of valmat (same size)
+  double obj;                                     // best objective value so far
+  int iter;                                       // number of completed iterations
+  int noimprove;                                  // number of consecutive iterations without improvement
+  arma::ivec aux;                                 // solver specific integer state
+  std::vector<int> seed;                          // state of the random number generator of R
+};
+
+
+class Checkpoint {
+  // periodic checkpoints of a solver to a binary file - the state is copied in the calling thread
+  // and written in the background to a temporary file, which then replaces the checkpoint, such
+  // that an interrupted write never corrupts it
+public:
+  Checkpoint(std::string file, int every, bool resume, int solver);
+  ~Checkpoint();
+
+  // a checkpoint is due every 'every' iterations, unless the previous one is still being written,
+  // such that the solver does not copy its state only to have it dropped
+  bool due(int iter) const { return every > 0 && iter % every == 0 && !writing; }
+  void save(CheckpointState state);
+  bool load(CheckpointState& state, int maxiter);
+  void finish();
+
+private:
+  std::string file;                               // checkpoint file, empty for no checkpoints
+  int every;                                      // number of iterations between checkpoints
+  bool resume;                                    // resume from file if it exists
+  int solver;                                     // identifies the solver that wrote the file
+  std::thread writer;                             // background thread writing the last checkpoint
+  std::atomic<bool> writing;                      // writer has not finished yet
+  std::atomic<bool> failed;                       // a write failed
+};
+
+
+#endif
@@ -1,12 +1,95 @@
 #include "RcppArmadillo.h"
+#include "helper.h"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 
 // [[Rcpp::depends(RcppArmadillo)]]
 using namespace Rcpp;
 
+
+// number of threads of the O(n_persons^2) kernels get_valmat, get_fnV and get_wsums, and the
+// smallest number of persons for which they run in parallel over blocks of columns
+static int kernel_nthreads = 1;
+static int kernel_minn = 1000;
+
+
+bool kernel_parallel(int n) {
+  // whether the kernels run in parallel for n persons
+  return kernel_nthreads > 1 && n >= kernel_minn;
+}
+
+
+// [[Rcpp::export]]
+IntegerVector kernel_threads(int n_threads, int min_persons) {
+  // sets the number of threads of the kernels that are linear in the size of valmat, which are used
+  // as soon as there are at least min_persons persons
+  //
+  // arguments:
+  // n_threads : number of threads (only when compiled with OpenMP)
+  // min_persons : smallest number of persons for which the kernels run in parallel
+  //
+  // output:
+  // previous : previous number of threads and smallest number of persons, to restore them
+  //
+  // author: Dries Cornilly
+
+  IntegerVector previous(2);
+  previous[0] = kernel_nthreads;
+  previous[1] = kernel_minn;
+#ifdef _OPENMP
+  kernel_nthreads = std::max(1, std::min(n_threads, omp_get_max_threads()));
+#else
+  kernel_nthreads = 1;
+#endif
+  kernel_minn = min_persons;
+  return previous;
+}
+
+
+void check_alloc(const arma::ivec& alloc, int n_items, int n_persons) {
+  // stops unless alloc assigns each of the n_items items to one of the persons 1, ..., n_persons -
+  // the kernels index valmat without bounds checks
+  if ((int) alloc.n_elem != n_items) stop("alloc must have one entry for each item.");
+  for (int ii = 0; ii < n_items; ii++) {
+    if (alloc(ii) < 1 || alloc(ii) > n_persons) {
+      stop("alloc must only contain persons 1, ..., n_persons.");
+    }
+  }
+}
+
+
+template <typename F>
+arma::mat fill_valmat(const arma::mat& vals, const F& owner, int n_items, int n_persons) {
+  // valuation matrix of the allocation in which item ii belongs to person owner(ii) (0-based)
+  arma::mat valmat = arma::zeros(n_persons, n_persons);
+  if (!kernel_parallel(n_persons)) {
+    for (int ii = 0; ii < n_items; ii++) {
+      simd_addcol(valmat.colptr(owner(ii)), vals.colptr(ii), n_persons);
+    }
+    return valmat;
+  }
+  
+  // each thread fills a block of columns, i.e. the sets of a block of persons
+  int blk = (n_persons + kernel_nthreads - 1) / kernel_nthreads;
+  #pragma omp parallel for num_threads(kernel_nthreads) schedule(static, 1)
+  for (int bb = 0; bb < kernel_nthreads; bb++) {
+    int lo = bb * blk;
+    int hi = std::min(lo + blk, n_persons);
+    for (int ii = 0; ii < n_items; ii++) {
+      int jj = owner(ii);
+      if (jj >= lo && jj < hi) simd_addcol(valmat.colptr(jj), vals.colptr(ii), n_persons);
+    }
+  }
+  
+  return valmat;
+}
+
+
 //' @export get_valmat
 // [[Rcpp::export]]
-arma::mat get_valmat(arma::mat vals, arma::ivec alloc, int n_items, int n_persons) {
+arma::mat get_valmat(const arma::mat& vals, const arma::ivec& alloc, int n_items, int n_persons) {
   // computes the matrix of dimension n_person x n_persons where each row contains
   // the valuation of that person for the different sets of items the other persons
   // receive
@@ -22,18 +105,43 @@ arma::mat get_valmat(arma::mat vals, arma::ivec alloc, int n_items, int n_person
   //
   // author: Dries Cornilly
 
-  arma::mat valmat = arma::zeros(n_persons, n_persons);
-  for (int ii = 0; ii < n_items; ii++) {
-    valmat.col(alloc(ii) - 1) += vals.col(ii);
+  if (n_items != (int) vals.n_cols || n_persons != (int) vals.n_rows) {
+    stop("n_items and n_persons must match the dimensions of vals.");
   }
-  
-  return valmat;
+  check_alloc(alloc, n_items, n_persons);
+  return fill_valmat(vals, [&alloc](int ii) { return (int) alloc(ii) - 1; }, n_items, n_persons);
+}
+
+
+arma::mat get_valmat(const arma::mat& vals, const Owners& owners, int n_items, int n_persons) {
+  // get_valmat for the internal 0-based allocation
+  return fill_valmat(vals, owners, n_items, n_persons);
+}
+
+
+Owners::Owners(const arma::ivec& alloc, int n_persons) {
+  int n_items = alloc.n_elem;
+  check_alloc(alloc, n_items, n_persons);         // the narrowing to 1 or 2 bytes would wrap silently
+  bytes = n_persons <= 256 ? 1 : (n_persons <= 65536 ? 2 : 4);
+  if (bytes == 1) o8.resize(n_items);
+  if (bytes == 2) o16.resize(n_items);
+  if (bytes == 4) o32.resize(n_items);
+  for (int ii = 0; ii < n_items; ii++) set(ii, alloc(ii) - 1);
+}
+
+
+arma::ivec Owners::alloc() const {
+  // 1-based allocation of the API
+  int n_items = bytes == 1 ? o8.size() : (bytes == 2 ? o16.size() : o32.size());
+  arma::ivec alloc(n_items);
+  for (int ii = 0; ii < n_items; ii++) alloc(ii) = (*this)(ii) + 1;
+  return alloc;
 }
 
 
 //' @export
 // [[Rcpp::export]]
-double get_maxenvy(arma::mat valmat, int n) {
+double get_maxenvy(const arma::mat& valmat, int n) {
   // gets the maximum envy from a matrix with valuations
   // 
   // arguments:
@@ -45,10 +153,12 @@ double get_maxenvy(arma::mat valmat, int n) {
   //
   // author: Dries Cornilly
   
-  for (int ii = 0; ii < n; ii++) {
-    valmat.row(ii) -= valmat(ii, ii);
-  }
-  double maxenvy = valmat.max();
+  // single pass over the columns, against a copy of the diagonal
+  double stackdiag[64];
+  std::vector<double> heapdiag(n > 64 ? n : 0);
+  double* diag = n > 64 ? heapdiag.data() : stackdiag;
+  for (int ii = 0; ii < n; ii++) diag[ii] = valmat(ii, ii);
+  double maxenvy = simd_maxenvy(valmat.memptr(), diag, n);
   
   return maxenvy;
 }
@@ -56,7 +166,7 @@ double get_maxenvy(arma::mat valmat, int n) {
 
 //' @export
 //[[Rcpp::export]]
-arma::mat get_avgval(arma::mat valmat, int n) {
+arma::mat get_avgval(const arma::mat& valmat, int n) {
   // gets the average value of the valuations of each person, arranged to have the same
   // dimensions as valmat - valmat can also be vals matrix of dimension n_persons x n_items,
   // in this case, n is still the number of persons
@@ -78,7 +188,7 @@ arma::mat get_avgval(arma::mat valmat, int n) {
 
 //' @export
 //[[Rcpp::export]]
-double get_fnV(arma::mat valmat, int n, arma::mat avgval) {
+double get_fnV(const arma::mat& valmat, int n, const arma::mat& avgval) {
   // gets the social inequality measure from a matrix with valuations
   // 
   // arguments:
@@ -92,7 +202,18 @@ double get_fnV(arma::mat valmat, int n, arma::mat avgval) {
   // author: Dries Cornilly
   
   double nn = 1.0 * n * n;
-  double v = arma::sum(arma::sum(arma::square(valmat - avgval), 1)) / nn;
+  if (!kernel_parallel(n)) return simd_sumsqdev(valmat.memptr(), avgval.memptr(), n, n) / nn;
+  
+  // reduction over blocks of columns
+  int blk = (n + kernel_nthreads - 1) / kernel_nthreads;
+  double s = 0.0;
+  #pragma omp parallel for num_threads(kernel_nthreads) schedule(static, 1) reduction(+:s)
+  for (int bb = 0; bb < kernel_nthreads; bb++) {
+    int lo = bb * blk;
+    int hi = std::min(lo + blk, n);
+    if (lo < hi) s += simd_sumsqdev(valmat.colptr(lo), avgval.memptr(), n, hi - lo);
+  }
+  double v = s / nn;
   return v;
 }
 
@@ -113,3 +234,193 @@ double get_util(arma::mat valmat) {
   double u = arma::prod(arma::diagvec(valmat));
   return u;
 }
+
+
+//' @export
+//[[Rcpp::export]]
+arma::vec get_objectives(const arma::mat& valmat, int n, const arma::mat& avgval) {
+  // gets maxenvy, the social inequality measure and the product of the utilities in a single pass
+  // over a matrix with valuations
+  // 
+  // arguments:
+  // valmat   : valuation matrix of the different sets (columns) to each person (row)
+  // n        : number of rows / columns of valmat
+  // avgval   : matrix with average valuations for each agent (see get_avgval)
+  //
+  // output:
+  // obj      : vector with maxenvy, social inequality and utility of the allocation
+  //
+  // author: Dries Cornilly
+  
+  // copy of the diagonal gives the utilities
+  double stackdiag[64];
+  std::vector<double> heapdiag(n > 64 ? n : 0);
+  double* diag = n > 64 ? heapdiag.data() : stackdiag;
+  double util = 1.0;
+  for (int ii = 0; ii < n; ii++) {
+    diag[ii] = valmat(ii, ii);
+    util *= diag[ii];
+  }
+  
+  // single pass over the columns for envy and deviations from the averages
+  const double* avg = avgval.memptr();
+  double maxenvy = 0.0;
+  double s = 0.0;
+  for (int jj = 0; jj < n; jj++) {
+    const double* col = valmat.colptr(jj);
+    for (int ii = 0; ii < n; ii++) {
+      maxenvy = std::max(maxenvy, col[ii] - diag[ii]);
+      double d = col[ii] - avg[ii];
+      s += d * d;
+    }
+  }
+  
+  arma::vec obj = {maxenvy, s / (1.0 * n * n), util};
+  return obj;
+}
+
+
+static inline double wsum_col(const double* w, const double* col, int n) {
+  // weighted sum of a column of valmat
+  double sum = 0.0;
+  for (int ll = 0; ll < n; ll++) sum += w[ll] * col[ll];
+  return sum;
+}
+
+
+arma::rowvec get_wsums(const arma::vec& w, const arma::mat& valmat) {
+  // weighted column sums w' * valmat, computed over blocks of columns in parallel for many persons -
+  // plain loops over the columns, such that the kernel does not call BLAS
+  int n = valmat.n_rows;
+  int m = valmat.n_cols;
+  arma::rowvec L(m);
+  if (!kernel_parallel(n)) {
+    for (int kk = 0; kk < m; kk++) L(kk) = wsum_col(w.memptr(), valmat.colptr(kk), n);
+    return L;
+  }
+  #pragma omp parallel for num_threads(kernel_nthreads) schedule(static)
+  for (int kk = 0; kk < m; kk++) L(kk) = wsum_col(w.memptr(), valmat.colptr(kk), n);
+  return L;
+}
+
+
+bool get_drift(const arma::mat& valmat, const arma::vec& totals, const arma::vec& scale) {
+  // checks whether incremental updates made valmat drift away from the allocation - every item
+  // belongs to exactly one set, so row ii of valmat sums to totals(ii) up to rounding relative to
+  // scale(ii), the sum of the absolute valuations of person ii
+  int n = valmat.n_rows;
+  for (int ii = 0; ii < n; ii++) {
+    double s = 0.0;
+    for (int jj = 0; jj < n; jj++) s += valmat(ii, jj);
+    if (std::abs(s - totals(ii)) > 1e-10 * scale(ii)) return true;
+  }
+  return false;
+}
+
+
+//' @export
+//[[Rcpp::export]]
+double get_fnV_lb(const arma::mat& vals, int n) {
+  // gets a lower bound on the social inequality measure of any allocation, based on the item
+  // granularity of the (nonnegative) valuations. For each person, the set containing its most
+  // valued item is worth at least that item, while the other sets at best share the rest equally.
+  // With fewer items than persons, some sets are empty as well.
+  // 
+  // arguments:
+  // vals     : matrix (n_persons x n_items) with each row the valuation of that person for the items
+  // n        : number of persons
+  //
+  // output:
+  // lb       : lower bound on the social inequality measure
+  //
+  // author: Dries Cornilly
+  
+  int n_items = vals.n_cols;
+  double lb = 0.0;
+  for (int ii = 0; ii < n; ii++) {
+    double total = arma::sum(vals.row(ii));
+    double avg = total / n;
+    double vmax = vals.row(ii).max();
+    double lbrow = 0.0;
+    if (n > 1 && vmax > avg) {
+      lbrow = n / (n - 1.0) * (vmax - avg) * (vmax - avg);
+    }
+    if (n_items < n) {
+      double share = total / n_items - avg;
+      lbrow = std::max(lbrow, (n - n_items) * avg * avg + n_items * share * share);
+    }
+    lb += lbrow;
+  }
+  
+  return lb / (1.0 * n * n);
+}
+
+
+//' @export
+//[[Rcpp::export]]
+double get_maxenvy_lb(const arma::mat& vals, int n) {
+  // gets a lower bound on the maximum envy of any allocation of the (nonnegative) valuations. With
+  // fewer items than persons, some person receives nothing and envies a set with at least one item.
+  // Otherwise, an envy-free allocation can not be excluded cheaply and the bound is zero.
+  // 
+  // arguments:
+  // vals     : matrix (n_persons x n_items) with each row the valuation of that person for the items
+  // n        : number of persons
+  //
+  // output:
+  // lb       : lower bound on the maximum envy
+  //
+  // author: Dries Cornilly
+  
+  int n_items = vals.n_cols;
+  double lb = 0.0;
+  if (n_items > 0 && n_items < n) lb = vals.min();
+  
+  return std::max(lb, 0.0);
+}
+
+
+//' @export
+//[[Rcpp::export]]
+double get_util_ub(const arma::mat& vals, int n) {
+  // gets an upper bound on the product of the utilities of any allocation of the (nonnegative)
+  // valuations. Each item adds at most max_i vals(i, item) / total_i to the sum of the relative
+  // utilities, such that the arithmetic-geometric mean inequality bounds their product.
+  // 
+  // arguments:
+  // vals     : matrix (n_persons x n_items) with each row the valuation of that person for the items
+  // n        : number of persons
+  //
+  // output:
+  // ub       : upper bound on the product of the utilities
+  //
+  // author: Dries Cornilly
+  
+  arma::vec total = arma::sum(vals, 1);
+  if (total.min() <= 0.0) return 0.0;
+  double share = 0.0;
+  for (arma::uword jj = 0; jj < vals.n_cols; jj++) share += arma::max(vals.col(jj) / total);
+  share /= n;
+  double ub = arma::prod(total) * std::pow(std::min(share, 1.0), n);
+  
+  return ub;
+}
+
+
+double get_gap(double obj, double bound) {
+  // gets the relative gap between an objective value and a bound on its optimal value
+  // 
+  // arguments:
+  // obj      : objective value
+  // bound    : lower bound (minimization) or upper bound (maximization) on the optimal value
+  //
+  // output:
+  // gap      : |obj - bound| / max(|obj|, |bound|), zero when both are zero
+  //
+  // author: Dries Cornilly
+  
+  double scale = std::max(std::fabs(obj), std::fabs(bound));
+  if (scale <= 0.0) return 0.0;
+  
+  return std::fabs(obj - bound) / scale;
+}
@@ -2,20 +2,187 @@
 #define HELPER_H
 
 #include "RcppArmadillo.h"
+#include <cstdint>
+#include <vector>
 
 // [[Rcpp::depends(RcppArmadillo)]]
 using namespace Rcpp;
 
 
-arma::mat get_valmat(arma::mat vals, arma::ivec alloc, int n_items, int n_persons);
+class Owners {
+  // 0-based index of the person to which each item belongs, stored in 8 or 16 bits whenever the
+  // number of persons allows it - the solvers convert from and to the 1-based alloc of the API only
+  // at their start and end
+public:
+  Owners() : bytes(4) {}
+  Owners(const arma::ivec& alloc, int n_persons);
 
-double get_maxenvy(arma::mat valmat, int n);
+  int operator()(int item) const {
+    return bytes == 1 ? o8[item] : (bytes == 2 ? o16[item] : o32[item]);
+  }
+  void set(int item, int person) {
+    if (bytes == 1) {
+      o8[item] = person;
+    } else if (bytes == 2) {
+      o16[item] = person;
+    } else {
+      o32[item] = person;
+    }
+  }
+  arma::ivec alloc() const;
 
-arma::mat get_avgval(arma::mat valmat, int n);
+private:
+  int bytes;                                      // bytes per item
+  std::vector<uint8_t> o8;
+  std::vector<uint16_t> o16;
+  std::vector<int32_t> o32;
+};
 
-double get_fnV(arma::mat valmat, int n, arma::mat avgval);
+
+struct Trace {
+  // objective values through the iterations, which are not kept for compact results
+  arma::vec values;
+  bool keep;
+
+  Trace(int n, bool keep) : values(arma::zeros(keep ? n : 0)), keep(keep) {}
+  void set(int ii, double v) {
+    if (keep) values(ii) = v;
+  }
+};
+
+
+IntegerVector kernel_threads(int n_threads, int min_persons);
+
+void check_alloc(const arma::ivec& alloc, int n_items, int n_persons);
+
+arma::mat get_valmat(const arma::mat& vals, const arma::ivec& alloc, int n_items, int n_persons);
+
+arma::mat get_valmat(const arma::mat& vals, const Owners& owners, int n_items, int n_persons);
+
+double get_maxenvy(const arma::mat& valmat, int n);
+
+arma::mat get_avgval(const arma::mat& valmat, int n);
+
+double get_fnV(const arma::mat& valmat, int n, const arma::mat& avgval);
 
 double get_util(arma::mat valmat);
 
+arma::vec get_objectives(const arma::mat& valmat, int n, const arma::mat& avgval);
+
+arma::rowvec get_wsums(const arma::vec& w, const arma::mat& valmat);
+
+bool get_drift(const arma::mat& valmat, const arma::vec& totals, const arma::vec& scale);
+
+double get_fnV_lb(const arma::mat& vals, int n);
+
+double get_maxenvy_lb(const arma::mat& vals, int n);
+
+double get_util_ub(const arma::mat& vals, int n);
+
+double get_gap(double obj, double bound);
+
+double simd_maxenvy(const double* valmat, const double* diag, int n);
+
+double simd_sumsqdev(const double* valmat, const double* avg, int n, int m);
+
+void simd_addcol(double* y, const double* x, int n);
+
+
+// fixed-size versions of the objectives for n_persons == N, with N == 0 for the generic versions
+#if defined(__clang__)
+#define FAIG_UNROLL _Pragma("unroll")
+#elif defined(__GNUC__) && __GNUC__ >= 8
+#define FAIG_UNROLL _Pragma("GCC unroll 8")
+#else
+#define FAIG_UNROLL
+#endif
+
+template <int N>
+struct Valmat {
+  typedef arma::mat::fixed<N, N> type;            // valuation matrix on the stack
+};
+
+template <>
+struct Valmat<0> {
+  typedef arma::mat type;
+};
+
+template <int N>
+inline double maxenvy_n(const arma::mat& valmat, int n) {
+  // get_maxenvy, fully unrolled for n == N
+  if (N == 0) return get_maxenvy(valmat, n);
+  const double* v = valmat.memptr();
+  double m = 0.0;
+  FAIG_UNROLL
+  for (int jj = 0; jj < N; jj++) {
+    FAIG_UNROLL
+    for (int ii = 0; ii < N; ii++) m = std::max(m, v[jj * N + ii] - v[ii * N + ii]);
+  }
+  return m;
+}
+
+template <int N>
+inline double fnV_n(const arma::mat& valmat, int n, const arma::mat& avgval) {
+  // get_fnV, fully unrolled for n == N
+  if (N == 0) return get_fnV(valmat, n, avgval);
+  const double* v = valmat.memptr();
+  const double* a = avgval.memptr();
+  double s = 0.0;
+  FAIG_UNROLL
+  for (int jj = 0; jj < N; jj++) {
+    FAIG_UNROLL
+    for (int ii = 0; ii < N; ii++) {
+      double d = v[jj * N + ii] - a[ii];
+      s += d * d;
+    }
+  }
+  return s / (1.0 * N * N);
+}
+
+template <int N>
+inline void move_item(arma::mat& valmat, const arma::mat& vals, int item, int oldperson, int newperson,
+                      int n) {
+  // moves the values of an item from set oldperson to set newperson, fully unrolled for n == N
+  const int m = N > 0 ? N : n;
+  const double* v = vals.colptr(item);
+  double* a = valmat.colptr(oldperson);
+  double* b = valmat.colptr(newperson);
+  FAIG_UNROLL
+  for (int ii = 0; ii < m; ii++) {
+    a[ii] -= v[ii];
+    b[ii] += v[ii];
+  }
+}
+
+
+// compensated updates of valmat, which keep the rounding errors of the incremental updates in comp,
+// and the number of iterations between checks of valmat against the allocation with get_drift
+static const int resync_every = 1024;
+
+inline void kahan_add(double& sum, double& comp, double x) {
+  // sum += x with compensated (Kahan) summation, comp holds the rounding error of sum
+  double y = x - comp;
+  double t = sum + y;
+  comp = (t - sum) - y;
+  sum = t;
+}
+
+template <int N>
+inline void move_item_comp(arma::mat& valmat, arma::mat& comp, const arma::mat& vals, int item,
+                           int oldperson, int newperson, int n) {
+  // move_item with compensated summation
+  const int m = N > 0 ? N : n;
+  const double* v = vals.colptr(item);
+  double* a = valmat.colptr(oldperson);
+  double* b = valmat.colptr(newperson);
+  double* ca = comp.colptr(oldperson);
+  double* cb = comp.colptr(newperson);
+  FAIG_UNROLL
+  for (int ii = 0; ii < m; ii++) {
+    kahan_add(a[ii], ca[ii], -v[ii]);
+    kahan_add(b[ii], cb[ii], v[ii]);
+  }
+}
+
 
 #endif
@@ -0,0 +1,229 @@
+#include "RcppArmadillo.h"
+#include "helper.h"
+
+
+// [[Rcpp::depends(RcppArmadillo)]]
+using namespace Rcpp;
+
+
+// [[Rcpp::export]]
+arma::ivec roundrobin_alloc(arma::mat vals) {
+  // round-robin allocation - the persons take turns and each picks the item with the highest
+  // valuation among the items that are still available
+  //
+  // arguments:
+  // vals     : matrix (n_persons x n_items) with each row the valuation of that person for the items
+  //
+  // output:
+  // alloc    : index of the person to which each item belongs (in 1, 2, ..., n_persons)
+  //
+  // author: Dries Cornilly
+
+  // initialize - each person walks through its own ranking of the items
+  int n_items = vals.n_cols;                      // number of items to distribute
+  int n_persons = vals.n_rows;                    // number of persons to distribute among
+  arma::ivec alloc = arma::zeros<arma::ivec>(n_items);
+  arma::umat ranking(n_items, n_persons);
+  for (int jj = 0; jj < n_persons; jj++) {
+    ranking.col(jj) = arma::sort_index(vals.row(jj), "descend");
+  }
+  arma::uvec next = arma::zeros<arma::uvec>(n_persons);
+
+  // persons pick in turn, skipping items that are already taken
+  for (int ii = 0; ii < n_items; ii++) {
+    int person = ii % n_persons;
+    while (alloc(ranking(next(person), person)) != 0) next(person)++;
+    alloc(ranking(next(person), person)) = person + 1;
+  }
+
+  return alloc;
+}
+
+
+bool envies(const arma::mat& valmat, const arma::ivec& holds, int person, int bundle) {
+  // checks whether a person envies the holder of a bundle
+  return bundle != holds(person) && valmat(person, bundle) > valmat(person, holds(person));
+}
+
+
+// [[Rcpp::export]]
+arma::ivec envycycle_alloc(arma::mat vals) {
+  // envy-cycle elimination - items are handed out in decreasing order of total value, each to a
+  // person that nobody envies. If everybody is envied, there is an envy cycle and the bundles are
+  // rotated along that cycle first. The result has maxenvy bounded by the largest single item value.
+  //
+  // arguments:
+  // vals     : matrix (n_persons x n_items) with each row the valuation of that person for the items
+  //
+  // output:
+  // alloc    : index of the person to which each item belongs (in 1, 2, ..., n_persons)
+  //
+  // author: Dries Cornilly
+
+  // initialize - bundles are kept fixed in valmat, rotations only change who holds them
+  int n_items = vals.n_cols;                      // number of items to distribute
+  int n_persons = vals.n_rows;                    // number of persons to distribute among
+  arma::uvec order = arma::sort_index(arma::sum(vals, 0), "descend");
+  arma::mat valmat = arma::zeros(n_persons, n_persons); // value of each bundle (column) for each person (row)
+  arma::ivec bundle(n_items);                     // bundle to which each item is added
+  arma::ivec holds(n_persons);                    // bundle held by each person
+  arma::ivec owner(n_persons);                    // person holding each bundle
+  arma::ivec envied = arma::zeros<arma::ivec>(n_persons); // number of persons envying each bundle
+  for (int jj = 0; jj < n_persons; jj++) {
+    holds(jj) = jj;
+    owner(jj) = jj;
+  }
+
+  for (int ii = 0; ii < n_items; ii++) {
+    int item = order(ii);
+
+    // find a bundle nobody envies, eliminating envy cycles until there is one
+    int target = -1;
+    while (target < 0) {
+      for (int bb = 0; bb < n_persons && target < 0; bb++) {
+        if (envied(bb) == 0) target = bb;
+      }
+      if (target >= 0) break;
+
+      // everybody is envied - walk backwards along envy edges until a person repeats
+      arma::ivec pos = arma::zeros<arma::ivec>(n_persons) - 1;
+      std::vector<int> path;
+      int cur = 0;
+      while (pos(cur) < 0) {
+        pos(cur) = path.size();
+        path.push_back(cur);
+        int next = 0;
+        while (!envies(valmat, holds, next, holds(cur))) next++;
+        cur = next;
+      }
+
+      // each person on the cycle takes the bundle it envies
+      std::vector<int> cycle(path.begin() + pos(cur), path.end());
+      int m = cycle.size();
+      arma::ivec oldholds = holds;
+      for (int kk = 0; kk < m; kk++) {
+        holds(cycle[(kk + 1) % m]) = oldholds(cycle[kk]);
+      }
+      for (int jj = 0; jj < n_persons; jj++) owner(holds(jj)) = jj;
+
+      // recompute the envy counts
+      envied.zeros();
+      for (int jj = 0; jj < n_persons; jj++) {
+        for (int bb = 0; bb < n_persons; bb++) envied(bb) += envies(valmat, holds, jj, bb);
+      }
+    }
+
+    // add the item to the target bundle - only envy towards this bundle and of its holder can change
+    int holder = owner(target);
+    for (int jj = 0; jj < n_persons; jj++) envied(target) -= envies(valmat, holds, jj, target);
+    for (int bb = 0; bb < n_persons; bb++) envied(bb) -= envies(valmat, holds, holder, bb);
+    valmat.col(target) += vals.col(item);
+    bundle(item) = target;
+    for (int jj = 0; jj < n_persons; jj++) envied(target) += envies(valmat, holds, jj, target);
+    for (int bb = 0; bb < n_persons; bb++) envied(bb) += envies(valmat, holds, holder, bb);
+  }
+
+  // translate bundles to persons
+  arma::ivec alloc(n_items);
+  for (int ii = 0; ii < n_items; ii++) alloc(ii) = owner(bundle(ii)) + 1;
+
+  return alloc;
+}
+
+
+// [[Rcpp::export]]
+arma::ivec greedysoc_alloc(arma::mat vals) {
+  // greedy allocation for social inequality - items are handed out in decreasing order of total
+  // value, each to the person for which the social inequality measure decreases most, measured
+  // with respect to the average valuations of the complete set of items
+  //
+  // arguments:
+  // vals     : matrix (n_persons x n_items) with each row the valuation of that person for the items
+  //
+  // output:
+  // alloc    : index of the person to which each item belongs (in 1, 2, ..., n_persons)
+  //
+  // author: Dries Cornilly
+
+  // initialize
+  int n_items = vals.n_cols;                      // number of items to distribute
+  int n_persons = vals.n_rows;                    // number of persons to distribute among
+  arma::uvec order = arma::sort_index(arma::sum(vals, 0), "descend");
+  arma::vec avg = arma::sum(vals, 1) / (1.0 * n_persons); // target value of each set for each person
+  arma::mat valmat = arma::zeros(n_persons, n_persons);
+  arma::ivec alloc(n_items);
+
+  for (int ii = 0; ii < n_items; ii++) {
+    int item = order(ii);
+
+    // change in sum((valmat - avgval)^2) when adding the item to set jj
+    int newperson = 0;
+    double mindelta = arma::datum::inf;
+    for (int jj = 0; jj < n_persons; jj++) {
+      double delta = 0.0;
+      for (int kk = 0; kk < n_persons; kk++) {
+        double v = vals(kk, item);
+        delta += v * (2.0 * (valmat(kk, jj) - avg(kk)) + v);
+      }
+      if (delta < mindelta) {
+        mindelta = delta;
+        newperson = jj;
+      }
+    }
+
+    valmat.col(newperson) += vals.col(item);
+    alloc(item) = newperson + 1;
+  }
+
+  return alloc;
+}
+
+
+// [[Rcpp::export]]
+arma::ivec greedyutil_alloc(arma::mat vals) {
+  // greedy allocation for the product of utilities - items are handed out in decreasing order of
+  // total value, each to the person whose own value increases most in relative terms. Persons that
+  // still have a zero value take precedence, so that the product becomes positive as soon as possible.
+  //
+  // arguments:
+  // vals     : matrix (n_persons x n_items) with each row the valuation of that person for the items
+  //
+  // output:
+  // alloc    : index of the person to which each item belongs (in 1, 2, ..., n_persons)
+  //
+  // author: Dries Cornilly
+
+  // initialize
+  int n_items = vals.n_cols;                      // number of items to distribute
+  int n_persons = vals.n_rows;                    // number of persons to distribute among
+  arma::uvec order = arma::sort_index(arma::sum(vals, 0), "descend");
+  arma::vec setvals = arma::zeros(n_persons);     // current value of each set for its owner
+  arma::ivec alloc(n_items);
+
+  for (int ii = 0; ii < n_items; ii++) {
+    int item = order(ii);
+
+    // largest value among empty sets, otherwise largest relative increase
+    int newperson = 0;
+    double maxgain = -arma::datum::inf;
+    bool empty = false;
+    for (int jj = 0; jj < n_persons; jj++) {
+      double v = vals(jj, item);
+      if (setvals(jj) <= 0.0) {
+        if (v > 0.0 && (!empty || v > maxgain)) {
+          empty = true;
+          maxgain = v;
+          newperson = jj;
+        }
+      } else if (!empty && v / setvals(jj) > maxgain) {
+        maxgain = v / setvals(jj);
+        newperson = jj;
+      }
+    }
+
+    setvals(newperson) += vals(newperson, item);
+    alloc(item) = newperson + 1;
+  }
+
+  return alloc;
+}
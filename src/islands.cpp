@@ -0,0 +1,278 @@
+#include "RcppArmadillo.h"
+#include "helper.h"
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <random>
+#include <thread>
+#include <utility>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+
+// [[Rcpp::depends(RcppArmadillo)]]
+using namespace Rcpp;
+
+
+struct Elite {
+  // immutable snapshot of an allocation that is shared between the islands
+  Owners alloc;                                   // index of the person to which each item belongs (0-based)
+  arma::mat valmat;                               // valuation matrix of alloc
+  arma::mat valcomp;                              // rounding errors of valmat
+  double obj;                                     // objective value of alloc
+};
+
+
+struct Slot {
+  // slot of an island in the migration channel - the published snapshot is swapped atomically, the
+  // snapshots it replaced are freed once no worker can still be reading them
+  std::atomic<const Elite*> elite;                // last published snapshot
+  std::vector<std::pair<long, const Elite*> > replaced; // replaced snapshots with their epoch
+};
+
+
+struct Island {
+  // state of a single chain of localtrades moves
+  Owners alloc;                                   // index of the person to which each item belongs (0-based)
+  arma::mat valmat;                               // valuation matrix of alloc
+  arma::mat valmattemp;                           // workspace for the proposed move
+  arma::mat valcomp;                              // rounding errors of the updates of valmat
+  double obj;                                     // objective value of alloc
+  int noimprove;                                  // number of consecutive moves without improvement
+  long nmoves;                                    // number of moves of the island
+  std::mt19937_64 rng;                            // private random number generator
+  std::atomic<bool> busy;                         // a worker is evolving this island
+  std::atomic<bool> retired;                      // no improvement for maxnoimprove moves
+};
+
+
+double island_obj(const arma::mat& valmat, int obj, int n_persons, const arma::mat& avgval) {
+  // objective value of a valuation matrix: 0 (social inequality) or 1 (maxenvy)
+  return obj == 0 ? get_fnV(valmat, n_persons, avgval) : get_maxenvy(valmat, n_persons);
+}
+
+
+// [[Rcpp::export]]
+List islands(arma::mat vals, const arma::ivec& alloc, int obj, int n_islands, int n_threads,
+             int migrate, int maxiter, int maxnoimprove, double eps, double reltol, bool compact) {
+  // island model for localtrades - every island runs its own chain of localtrades moves (randomly
+  // choose an item and give it to a different person if it decreases the objective). Workers grab
+  // blocks of migrate moves from a shared budget of maxiter moves and evolve any island that is
+  // not being evolved, starting from a shared cursor, such that all islands progress and idle
+  // workers take over the islands of others. After each block, the island publishes its allocation
+  // and adopts the one published by its neighbour on a ring if that one is better. The channel is
+  // lock-free: a reader announces the epoch at which it last held no snapshot, and a replaced
+  // snapshot is freed once every worker announced a later epoch. Each island updates its valmat with
+  // compensated summation and resynchronizes it with the allocation if it drifted. This is done
+  // until the objective drops below eps, until the budget is spent, or until every island had no
+  // improvement for maxnoimprove moves.
+  //
+  // arguments:
+  // vals     : matrix (n_persons x n_items) with each row the valuation of that person for the items
+  // alloc    : index of the person to which each item belongs, initial allocation of the first island;
+  //            the other islands start from a random allocation
+  // obj      : objective to minimize: 0 (social inequality) or 1 (maxenvy)
+  // n_islands : number of islands
+  // n_threads : number of worker threads (only when compiled with OpenMP)
+  // migrate  : number of moves of an island between migrations
+  // maxiter  : maximum number of moves over all islands
+  // maxnoimprove : retire an island if no improvement for maxnoimprove consecutive moves
+  // eps      : terminate if the objective < eps
+  // reltol   : terminate if the relative gap to the lower bound is below reltol
+  // compact  : leave valmat out of the output
+  //
+  // output:
+  // alloc    : optimal allocation
+  // minsoc / minmaxenvy : optimal value of the objective - corresponds to alloc
+  // valmat   : valuation matrix of the different sets (columns) to each person (row), not if compact
+  // islandobj : final objective value of each island
+  // status   : 0 (V < eps); 1 (maxiter reached); 2 (no improvement); 4 (gap < reltol)
+  // iter     : number of moves the algorithm completed before stopping
+  // migrations : number of allocations adopted from a neighbour
+  // bound    : lower bound on the optimal value
+  // gap      : relative gap between the final objective value and bound
+  //
+  // author: Dries Cornilly
+
+  // initialize
+  if (n_islands < 1) stop("n_islands must be at least 1.");
+  if (migrate < 1) stop("migrate must be at least 1.");
+  int n_items = vals.n_cols;                      // number of items to distribute
+  int n_persons = vals.n_rows;                    // number of persons to distribute among
+  arma::mat avgval = get_avgval(vals, n_persons); // initialize average valuations
+  double bound = obj == 0 ? get_fnV_lb(vals, n_persons) : get_maxenvy_lb(vals, n_persons);
+  arma::vec totals = arma::sum(vals, 1);          // row sums of valmat
+  arma::vec scale = arma::sum(arma::abs(vals), 1); // scale of the rounding errors in totals
+  n_threads = std::max(n_threads, 1);
+  arma::ivec seeds = arma::randi(n_islands, arma::distr_param(0, 2147483646));
+
+  // initialize the islands and their slots in the migration channel - random numbers are drawn here,
+  // as the random number generator of R must not be used by the workers
+  std::vector<Island> island(n_islands);
+  std::vector<Slot> channel(n_islands);
+  for (int kk = 0; kk < n_islands; kk++) {
+    Island& isl = island[kk];
+    if (kk == 0) {
+      isl.alloc = Owners(alloc, n_persons);
+    } else {
+      isl.alloc = Owners(arma::randi(n_items, arma::distr_param(1, n_persons)), n_persons);
+    }
+    isl.valmat = get_valmat(vals, isl.alloc, n_items, n_persons);
+    isl.valcomp = arma::zeros(n_persons, n_persons);
+    isl.obj = island_obj(isl.valmat, obj, n_persons, avgval);
+    isl.noimprove = 0;
+    isl.nmoves = 0;
+    channel[kk].elite = nullptr;
+    isl.rng.seed(seeds(kk));
+    isl.busy = false;
+    isl.retired = false;
+  }
+
+  std::atomic<long> moves(0);                     // moves claimed from the budget
+  std::atomic<int> migrations(0);                 // number of adopted allocations
+  std::atomic<int> retired(0);                    // number of retired islands
+  std::atomic<int> status(1);
+  std::atomic<bool> stop(false);
+  std::atomic<unsigned> cursor(0);                // first island to try when acquiring one
+  std::atomic<long> epoch(0);                     // number of replaced snapshots
+  std::vector<std::atomic<long> > seen(n_threads); // epoch at which each worker last held no snapshot
+  for (int ww = 0; ww < n_threads; ww++) seen[ww] = LONG_MAX;
+
+  // the workers are the parallelism - the kernels run single-threaded inside them
+  IntegerVector kernels = kernel_threads(1, 0);
+
+  #pragma omp parallel num_threads(n_threads)
+  {
+    int worker = 0;
+#ifdef _OPENMP
+    worker = omp_get_thread_num();
+#endif
+    std::uniform_int_distribution<int> itemdist(0, n_items - 1);
+    std::uniform_int_distribution<int> adddist(1, n_persons - 1);
+    int backoff = 1;                              // microseconds to wait while no island is idle
+
+    while (!stop) {
+      seen[worker] = epoch.load();
+
+      // acquire an island, starting from the shared cursor
+      int kk = -1;
+      unsigned first = cursor.fetch_add(1);
+      for (int ll = 0; ll < n_islands && kk < 0; ll++) {
+        int cand = (first + ll) % n_islands;
+        bool expected = false;
+        if (!island[cand].retired && island[cand].busy.compare_exchange_strong(expected, true)) {
+          kk = cand;
+        }
+      }
+      if (kk < 0) {
+        if (retired == n_islands || moves >= maxiter) break;
+        std::this_thread::sleep_for(std::chrono::microseconds(backoff));
+        backoff = std::min(2 * backoff, 1000);
+        continue;
+      }
+      backoff = 1;
+      Island& isl = island[kk];
+
+      // claim a block of moves from the budget
+      long start = moves.fetch_add(migrate);
+      int block = std::min((long) migrate, (long) maxiter - start);
+      if (block <= 0) {
+        isl.busy = false;
+        break;
+      }
+
+      // localtrades moves
+      for (int ii = 0; ii < block; ii++) {
+        int item = itemdist(isl.rng);
+        int oldperson = isl.alloc(item);
+        int newperson = (oldperson + adddist(isl.rng)) % n_persons;
+        isl.valmattemp = isl.valmat;
+        move_item<0>(isl.valmattemp, vals, item, oldperson, newperson, n_persons);
+        double objtemp = island_obj(isl.valmattemp, obj, n_persons, avgval);
+        if (objtemp < isl.obj) {
+          isl.obj = objtemp;
+          isl.alloc.set(item, newperson);
+          move_item_comp<0>(isl.valmat, isl.valcomp, vals, item, oldperson, newperson, n_persons);
+          isl.noimprove = 0;
+        } else {
+          isl.noimprove++;
+        }
+
+        // resynchronize valmat with the allocation if it drifted
+        isl.nmoves++;
+        if (isl.nmoves % resync_every == 0 && get_drift(isl.valmat, totals, scale)) {
+          isl.valmat = get_valmat(vals, isl.alloc, n_items, n_persons);
+          isl.valcomp.zeros();
+          isl.obj = island_obj(isl.valmat, obj, n_persons, avgval);
+        }
+      }
+
+      // publish the own allocation and adopt the one of the neighbour if it is better
+      Slot& slot = channel[kk];
+      const Elite* old = slot.elite.exchange(new Elite{isl.alloc, isl.valmat, isl.valcomp, isl.obj});
+      if (old) slot.replaced.push_back(std::make_pair(epoch.fetch_add(1), old));
+      const Elite* elite = channel[(kk + 1) % n_islands].elite.load();
+      if (elite && elite->obj < isl.obj) {
+        isl.alloc = elite->alloc;
+        isl.valmat = elite->valmat;
+        isl.valcomp = elite->valcomp;
+        isl.obj = elite->obj;
+        isl.noimprove = 0;
+        migrations++;
+      }
+
+      // free the replaced snapshots of this slot that no worker can still be reading
+      long safe = LONG_MAX;
+      for (int ww = 0; ww < n_threads; ww++) safe = std::min(safe, seen[ww].load());
+      size_t nkeep = 0;
+      for (size_t ll = 0; ll < slot.replaced.size(); ll++) {
+        if (slot.replaced[ll].first < safe) {
+          delete slot.replaced[ll].second;
+        } else {
+          slot.replaced[nkeep++] = slot.replaced[ll];
+        }
+      }
+      slot.replaced.resize(nkeep);
+
+      // check convergence
+      if (isl.obj < eps) {
+        status = 0;
+        stop = true;
+      } else if (get_gap(isl.obj, bound) < reltol) {
+        status = 4;
+        stop = true;
+      } else if (isl.noimprove >= maxnoimprove) {
+        isl.retired = true;
+        if (++retired == n_islands) status = 2;
+      }
+      isl.busy = false;
+    }
+    seen[worker] = LONG_MAX;
+  }
+  kernel_threads(kernels[0], kernels[1]);
+
+  // free the channel
+  for (int kk = 0; kk < n_islands; kk++) {
+    delete channel[kk].elite.load();
+    for (size_t ll = 0; ll < channel[kk].replaced.size(); ll++) delete channel[kk].replaced[ll].second;
+  }
+
+  // collect the best island
+  arma::vec islandobj(n_islands);
+  for (int kk = 0; kk < n_islands; kk++) islandobj(kk) = island[kk].obj;
+  int best = arma::index_min(islandobj);
+
+  List out;
+  out["alloc"] = island[best].alloc.alloc();
+  out[obj == 0 ? "minsoc" : "minmaxenvy"] = island[best].obj;
+  if (!compact) out["valmat"] = island[best].valmat;
+  out["islandobj"] = islandobj;
+  out["status"] = (int) status;
+  out["iter"] = std::min((long) maxiter, (long) moves);
+  out["migrations"] = (int) migrations;
+  out["bound"] = bound;
+  out["gap"] = get_gap(island[best].obj, bound);
+
+  return out;
+}
@@ -1,5 +1,6 @@
 #include "RcppArmadillo.h"
 #include "helper.h"
+#include "checkpoint.h"
 
 
 // [[Rcpp::depends(RcppArmadillo)]]
@@ -11,42 +12,49 @@ int testfunc(int oldperson, int addperson, int n_persons){
   return newperson;
 }
 
-// [[Rcpp::export]]
-List localtrades_envy(arma::mat vals, arma::ivec alloc, int maxiter, int maxnoimprove, double eps) {
-  // envy-swapping algorithm - randomly choose an item and allocate it to a different person if it
-  // decreases the maxenvy objective. This is done a maximum of maxiter steps, until a maxenvy of eps is
-  // reached, or until there is no improvement for maxnoimprove steps.
-  // 
-  // arguments:
-  // vals     : matrix (n_persons x n_items) with each row the valuation of that person for the items
-  // alloc    : index of the person to which each item belongs
-  // maxiter  : maximum number of iterations
-  // maxnoimprove : terminate if no improvement for maxnoimprove consecutive steps
-  // eps      : terminate if maxenvy < eps
-  //
-  // output:
-  // alloc    : optimal allocation 
-  // minmaxenvy : optimal value of maxenvy - corresponds to alloc
-  // valmat   : valuation matrix of the different sets (columns) to each person (row)
-  // envyvec  : vector with maxenvy values at the different iterations
-  // status   : 0 (V < eps); 1 (maxiter reached)
-  // iter     : number of iterations the algorithm completed before stopping
-  //
-  // author: Dries Cornilly
-  
+template <int N>
+List localtrades_envy_n(const arma::mat& vals, const arma::ivec& alloc, int maxiter,
+                        int maxnoimprove, double eps, double reltol, Checkpoint& ckpt, bool compact) {
+  // localtrades_envy for n_persons == N with valuation matrices on the stack, or for any n_persons
+  // if N == 0
+  typedef typename Valmat<N>::type Vmat;
+
   // initialize
   int n_items = vals.n_cols;                      // number of items to distribute
   int n_persons = vals.n_rows;                    // number of persons to distribute among
-  arma::mat valmat = get_valmat(vals, alloc, n_items, n_persons); // get value of each set of items for each person
-  arma::vec envyvec = arma::zeros(maxiter + 1);   // initialize maxenvy through iterations
-  double minmaxenvy = get_maxenvy(valmat, n_persons); // maxenvy at initial stage
-  envyvec(0) = minmaxenvy;
+  Owners owners(alloc, n_persons);                // 0-based allocation
+  Vmat valmat = get_valmat(vals, owners, n_items, n_persons); // get value of each set of items for each person
+  Vmat valmattemp = valmat;                       // workspace for the proposed reassignment
+  Vmat valcomp = arma::zeros(n_persons, n_persons); // rounding errors of the updates of valmat
+  arma::vec totals = arma::sum(vals, 1);          // row sums of valmat
+  arma::vec scale = arma::sum(arma::abs(vals), 1); // scale of the rounding errors in totals
+  Trace envyvec(maxiter + 1, !compact);           // initialize maxenvy through iterations
+  double minmaxenvy = maxenvy_n<N>(valmat, n_persons); // maxenvy at initial stage
+  envyvec.set(0, minmaxenvy);
+  double bound = get_maxenvy_lb(vals, n_persons); // lower bound on maxenvy
   
   // iterate
   int iter = 0;
   bool converged = false;
   int status = 1;
   int noimprove = 0;
+
+  // resume from a checkpoint - state is released before iterating
+  {
+    CheckpointState state = {alloc, arma::mat(valmat), arma::mat(valcomp), minmaxenvy, 0, 0,
+                             arma::ivec(), {}};
+    if (ckpt.load(state, maxiter)) {
+      owners = Owners(state.alloc, n_persons);
+      valmat = state.valmat;
+      valcomp = state.valcomp;
+      minmaxenvy = state.obj;
+      iter = state.iter;
+      noimprove = state.noimprove;
+      envyvec.set(0, 0.0);
+      envyvec.set(iter, minmaxenvy);
+    }
+  }
+
   while (iter < maxiter && !converged) {
     
     // sample items to give to a different owner
@@ -54,21 +62,18 @@ List localtrades_envy(arma::mat vals, arma::ivec alloc, int maxiter, int maxnoim
     int addperson = arma::randi(1, arma::distr_param(1, n_persons - 1))(0);
     
     // try the reassignment and update if improvements are made
-    arma::ivec alloctemp = alloc - 1;
-    arma::mat valmattemp = valmat;
-    int oldperson = alloctemp(item);
+    int oldperson = owners(item);
     int newperson = (oldperson + addperson) % n_persons;
-    valmattemp.col(oldperson) -= vals.col(item);
-    valmattemp.col(newperson) += vals.col(item);
-    alloctemp(item) = newperson;
-    double envytemp = get_maxenvy(valmattemp, n_persons);
-    envyvec(1 + iter) = envytemp;
+    valmattemp = valmat;
+    move_item<N>(valmattemp, vals, item, oldperson, newperson, n_persons);
+    double envytemp = maxenvy_n<N>(valmattemp, n_persons);
+    envyvec.set(1 + iter, envytemp);
     
     // update if lower maxenvy
     if (envytemp < minmaxenvy) {
       minmaxenvy = envytemp;
-      alloc = alloctemp + 1;
-      valmat = valmattemp;
+      owners.set(item, newperson);
+      move_item_comp<N>(valmat, valcomp, vals, item, oldperson, newperson, n_persons);
       noimprove = 0;
     } else {
       noimprove++;
@@ -78,63 +83,133 @@ List localtrades_envy(arma::mat vals, arma::ivec alloc, int maxiter, int maxnoim
     if (minmaxenvy < eps) {
       converged = true;
       status = 0;
+    } else if (get_gap(minmaxenvy, bound) < reltol) {
+      converged = true;
+      status = 4;
     } else if (noimprove >= maxnoimprove) {
       converged = true;
       status = 2;
     }
 
     iter++;
+
+    // resynchronize valmat with the allocation if it drifted
+    if (iter % resync_every == 0 && get_drift(valmat, totals, scale)) {
+      valmat = get_valmat(vals, owners, n_items, n_persons);
+      valcomp.zeros();
+      minmaxenvy = maxenvy_n<N>(valmat, n_persons);
+    }
+    if (ckpt.due(iter) && !converged) {
+      ckpt.save(CheckpointState{owners.alloc(), arma::mat(valmat), arma::mat(valcomp), minmaxenvy, iter,
+                                noimprove, arma::ivec(), {}});
+    }
   }
+  ckpt.finish();
   
   List out;
-  out["alloc"] = alloc;
+  out["alloc"] = owners.alloc();
   out["minmaxenvy"] = minmaxenvy;
-  out["valmat"] = valmat;
-  out["envyvec"] = envyvec;
+  if (!compact) {
+    out["valmat"] = valmat;
+    out["envyvec"] = envyvec.values;
+  }
   out["status"] = status;
   out["iter"] = iter;
+  out["bound"] = bound;
+  out["gap"] = get_gap(minmaxenvy, bound);
   
   return out;
 }
 
 
 // [[Rcpp::export]]
-List localtrades_social(arma::mat vals, arma::ivec alloc, int maxiter, int maxnoimprove, double eps) {
-  // social inequality-swapping algorithm - randomly choose an item and allocate it to a different 
-  // person if it decreases the social inequality objective. This is done a maximum of maxiter steps, 
-  // until a social inequality of eps is reached, or until there is no improvement for maxnoimprove steps.
+List localtrades_envy(arma::mat vals, const arma::ivec& alloc, int maxiter, int maxnoimprove,
+                      double eps, double reltol, std::string checkpoint, int every, bool resume,
+                      bool compact) {
+  // envy-swapping algorithm - randomly choose an item and allocate it to a different person if it
+  // decreases the maxenvy objective. This is done a maximum of maxiter steps, until a maxenvy of eps is
+  // reached, or until there is no improvement for maxnoimprove steps.
   // 
   // arguments:
   // vals     : matrix (n_persons x n_items) with each row the valuation of that person for the items
   // alloc    : index of the person to which each item belongs
   // maxiter  : maximum number of iterations
   // maxnoimprove : terminate if no improvement for maxnoimprove consecutive steps
-  // eps      : terminate if soc_ineq < eps
+  // eps      : terminate if maxenvy < eps
+  // reltol   : terminate if the relative gap to the lower bound is below reltol
+  // checkpoint : file to which the state is written every 'every' iterations, empty for none
+  // every    : number of iterations between checkpoints
+  // resume   : continue from checkpoint if it exists, the trace then starts at its iteration
+  // compact  : leave valmat and the trace out of the output
   //
   // output:
-  // alloc    : optimal allocation
-  // minsoc   : optimal value of social inequality - corresponds to alloc
-  // valmat   : valuation matrix of the different sets (columns) to each person (row)
-  // socvec   : vector with social inequality values at the different iterations
-  // status   : 0 (V < eps); 1 (maxiter reached)
+  // alloc    : optimal allocation 
+  // minmaxenvy : optimal value of maxenvy - corresponds to alloc
+  // valmat   : valuation matrix of the different sets (columns) to each person (row), not if compact
+  // envyvec  : vector with maxenvy values at the different iterations, not if compact
+  // status   : 0 (V < eps); 1 (maxiter reached); 2 (no improvement); 4 (gap < reltol)
   // iter     : number of iterations the algorithm completed before stopping
+  // bound    : lower bound on the optimal value
+  // gap      : relative gap between the final objective value and bound
   //
   // author: Dries Cornilly
   
+  // dispatch to the fixed-size instantiations for small numbers of persons
+  Checkpoint ckpt(checkpoint, every, resume, 0);
+  switch (vals.n_rows) {
+    case 2: return localtrades_envy_n<2>(vals, alloc, maxiter, maxnoimprove, eps, reltol, ckpt, compact);
+    case 3: return localtrades_envy_n<3>(vals, alloc, maxiter, maxnoimprove, eps, reltol, ckpt, compact);
+    case 4: return localtrades_envy_n<4>(vals, alloc, maxiter, maxnoimprove, eps, reltol, ckpt, compact);
+    case 8: return localtrades_envy_n<8>(vals, alloc, maxiter, maxnoimprove, eps, reltol, ckpt, compact);
+    default: return localtrades_envy_n<0>(vals, alloc, maxiter, maxnoimprove, eps, reltol, ckpt, compact);
+  }
+}
+
+
+template <int N>
+List localtrades_social_n(const arma::mat& vals, const arma::ivec& alloc, int maxiter,
+                          int maxnoimprove, double eps, double reltol, Checkpoint& ckpt, bool compact) {
+  // localtrades_social for n_persons == N with valuation matrices on the stack, or for any n_persons
+  // if N == 0
+  typedef typename Valmat<N>::type Vmat;
+
   // initialize
   int n_items = vals.n_cols;                      // number of items to distribute
   int n_persons = vals.n_rows;                    // number of persons to distribute among
-  arma::mat avgval = get_avgval(vals, n_persons); // initialize average valuations
-  arma::mat valmat = get_valmat(vals, alloc, n_items, n_persons); // get value of each set of items for each person
-  arma::vec socvec = arma::zeros(maxiter + 1);    // initialize social inequality through iterations
-  double minsoc = get_fnV(valmat, n_persons, avgval); // social inequality at initial stage
-  socvec(0) = minsoc;
+  Vmat avgval = get_avgval(vals, n_persons);      // initialize average valuations
+  Owners owners(alloc, n_persons);                // 0-based allocation
+  Vmat valmat = get_valmat(vals, owners, n_items, n_persons); // get value of each set of items for each person
+  Vmat valmattemp = valmat;                       // workspace for the proposed reassignment
+  Vmat valcomp = arma::zeros(n_persons, n_persons); // rounding errors of the updates of valmat
+  arma::vec totals = arma::sum(vals, 1);          // row sums of valmat
+  arma::vec scale = arma::sum(arma::abs(vals), 1); // scale of the rounding errors in totals
+  Trace socvec(maxiter + 1, !compact);            // initialize social inequality through iterations
+  double minsoc = fnV_n<N>(valmat, n_persons, avgval); // social inequality at initial stage
+  socvec.set(0, minsoc);
+  double bound = get_fnV_lb(vals, n_persons);     // lower bound on social inequality
   
   // iterate
   int iter = 0;
   bool converged = false;
   int status = 1;
   int noimprove = 0;
+
+  // resume from a checkpoint - state is released before iterating
+  {
+    CheckpointState state = {alloc, arma::mat(valmat), arma::mat(valcomp), minsoc, 0, 0,
+                             arma::ivec(), {}};
+    if (ckpt.load(state, maxiter)) {
+      owners = Owners(state.alloc, n_persons);
+      valmat = state.valmat;
+      valcomp = state.valcomp;
+      minsoc = state.obj;
+      iter = state.iter;
+      noimprove = state.noimprove;
+      socvec.set(0, 0.0);
+      socvec.set(iter, minsoc);
+    }
+  }
+
   while (iter < maxiter && !converged) {
     
     // sample items to give to a different owner
@@ -142,21 +217,18 @@ List localtrades_social(arma::mat vals, arma::ivec alloc, int maxiter, int maxno
     int addperson = arma::randi(1, arma::distr_param(1, n_persons - 1))(0);
     
     // try the reassignment and update if improvements are made
-    arma::ivec alloctemp = alloc - 1;
-    arma::mat valmattemp = valmat;
-    int oldperson = alloctemp(item);
+    int oldperson = owners(item);
     int newperson = (oldperson + addperson) % n_persons;
-    valmattemp.col(oldperson) -= vals.col(item);
-    valmattemp.col(newperson) += vals.col(item);
-    alloctemp(item) = newperson;
-    double soctemp = get_fnV(valmattemp, n_persons, avgval);
-    socvec(1 + iter) = soctemp;
+    valmattemp = valmat;
+    move_item<N>(valmattemp, vals, item, oldperson, newperson, n_persons);
+    double soctemp = fnV_n<N>(valmattemp, n_persons, avgval);
+    socvec.set(1 + iter, soctemp);
     
     // update if lower maxenvy
     if (soctemp < minsoc) {
       minsoc = soctemp;
-      alloc = alloctemp + 1;
-      valmat = valmattemp;
+      owners.set(item, newperson);
+      move_item_comp<N>(valmat, valcomp, vals, item, oldperson, newperson, n_persons);
       noimprove = 0;
     } else {
       noimprove++;
@@ -166,28 +238,93 @@ List localtrades_social(arma::mat vals, arma::ivec alloc, int maxiter, int maxno
     if (minsoc < eps) {
       converged = true;
       status = 0;
+    } else if (get_gap(minsoc, bound) < reltol) {
+      converged = true;
+      status = 4;
     } else if (noimprove >= maxnoimprove) {
       converged = true;
       status = 2;
     }
     
     iter++;
+
+    // resynchronize valmat with the allocation if it drifted
+    if (iter % resync_every == 0 && get_drift(valmat, totals, scale)) {
+      valmat = get_valmat(vals, owners, n_items, n_persons);
+      valcomp.zeros();
+      minsoc = fnV_n<N>(valmat, n_persons, avgval);
+    }
+    if (ckpt.due(iter) && !converged) {
+      ckpt.save(CheckpointState{owners.alloc(), arma::mat(valmat), arma::mat(valcomp), minsoc, iter,
+                                noimprove, arma::ivec(), {}});
+    }
   }
+  ckpt.finish();
   
   List out;
-  out["alloc"] = alloc;
+  out["alloc"] = owners.alloc();
   out["minsoc"] = minsoc;
-  out["valmat"] = valmat;
-  out["socvec"] = socvec;
+  if (!compact) {
+    out["valmat"] = valmat;
+    out["socvec"] = socvec.values;
+  }
   out["status"] = status;
   out["iter"] = iter;
+  out["bound"] = bound;
+  out["gap"] = get_gap(minsoc, bound);
   
   return out;
 }
 
 
 // [[Rcpp::export]]
-List localtrades_utility(arma::mat vals, arma::ivec alloc, int maxiter, int maxnoimprove, double eps) {
+List localtrades_social(arma::mat vals, const arma::ivec& alloc, int maxiter, int maxnoimprove,
+                        double eps, double reltol, std::string checkpoint, int every, bool resume,
+                        bool compact) {
+  // social inequality-swapping algorithm - randomly choose an item and allocate it to a different 
+  // person if it decreases the social inequality objective. This is done a maximum of maxiter steps, 
+  // until a social inequality of eps is reached, or until there is no improvement for maxnoimprove steps.
+  // 
+  // arguments:
+  // vals     : matrix (n_persons x n_items) with each row the valuation of that person for the items
+  // alloc    : index of the person to which each item belongs
+  // maxiter  : maximum number of iterations
+  // maxnoimprove : terminate if no improvement for maxnoimprove consecutive steps
+  // eps      : terminate if soc_ineq < eps
+  // reltol   : terminate if the relative gap to the lower bound is below reltol
+  // checkpoint : file to which the state is written every 'every' iterations, empty for none
+  // every    : number of iterations between checkpoints
+  // resume   : continue from checkpoint if it exists, the trace then starts at its iteration
+  // compact  : leave valmat and the trace out of the output
+  //
+  // output:
+  // alloc    : optimal allocation
+  // minsoc   : optimal value of social inequality - corresponds to alloc
+  // valmat   : valuation matrix of the different sets (columns) to each person (row), not if compact
+  // socvec   : vector with social inequality values at the different iterations, not if compact
+  // status   : 0 (V < eps); 1 (maxiter reached); 2 (no improvement); 4 (gap < reltol)
+  // iter     : number of iterations the algorithm completed before stopping
+  // bound    : lower bound on the optimal value
+  // gap      : relative gap between the final objective value and bound
+  //
+  // author: Dries Cornilly
+  
+  // dispatch to the fixed-size instantiations for small numbers of persons
+  Checkpoint ckpt(checkpoint, every, resume, 1);
+  switch (vals.n_rows) {
+    case 2: return localtrades_social_n<2>(vals, alloc, maxiter, maxnoimprove, eps, reltol, ckpt, compact);
+    case 3: return localtrades_social_n<3>(vals, alloc, maxiter, maxnoimprove, eps, reltol, ckpt, compact);
+    case 4: return localtrades_social_n<4>(vals, alloc, maxiter, maxnoimprove, eps, reltol, ckpt, compact);
+    case 8: return localtrades_social_n<8>(vals, alloc, maxiter, maxnoimprove, eps, reltol, ckpt, compact);
+    default: return localtrades_social_n<0>(vals, alloc, maxiter, maxnoimprove, eps, reltol, ckpt, compact);
+  }
+}
+
+
+// [[Rcpp::export]]
+List localtrades_utility(arma::mat vals, const arma::ivec& alloc, int maxiter, int maxnoimprove,
+                         double eps, double reltol, std::string checkpoint, int every, bool resume,
+                         bool compact) {
   // utility swapping algorithm - randomly choose an item and allocate it to a different 
   // person,if it increases the product of individual utilities. This is done a maximum of maxiter 
   // steps, or until there is no improvement for maxnoimprove steps.
@@ -198,31 +335,61 @@ List localtrades_utility(arma::mat vals, arma::ivec alloc, int maxiter, int maxn
   // maxiter  : maximum number of iterations
   // maxnoimprove : terminate if no improvement for maxnoimprove consecutive steps
   // eps      : terminate if max_util > eps
+  // reltol   : terminate if the relative gap to the upper bound is below reltol
+  // checkpoint : file to which the state is written every 'every' iterations, empty for none
+  // every    : number of iterations between checkpoints
+  // resume   : continue from checkpoint if it exists, the trace then starts at its iteration
+  // compact  : leave valmat and the trace out of the output
   //
   // output:
   // alloc    : optimal allocation
   // maxutil  : optimal value of utility - corresponds to alloc
-  // valmat   : valuation matrix of the different sets (columns) to each person (row)
-  // utilvec  : vector with utlity values at the different iterations
-  // status   : 0 (V > eps); 1 (maxiter reached)
+  // valmat   : valuation matrix of the different sets (columns) to each person (row), not if compact
+  // utilvec  : vector with utlity values at the different iterations, not if compact
+  // status   : 0 (V > eps); 1 (maxiter reached); 2 (no improvement); 4 (gap < reltol)
   // iter     : number of iterations the algorithm completed before stopping
+  // bound    : upper bound on the optimal value
+  // gap      : relative gap between the final objective value and bound
   //
   // author: Dries Cornilly
   
   // initialize
   int n_items = vals.n_cols;                      // number of items to distribute
   int n_persons = vals.n_rows;                    // number of persons to distribute among
-  arma::mat valmat = get_valmat(vals, alloc, n_items, n_persons); // get value of each set of items for each person
-  arma::vec utilvec = arma::zeros(maxiter + 1);   // initialize social inequality through iterations
+  Owners owners(alloc, n_persons);                // 0-based allocation
+  arma::mat valmat = get_valmat(vals, owners, n_items, n_persons); // get value of each set of items for each person
+  Trace utilvec(maxiter + 1, !compact);           // initialize utility through iterations
   double maxutil = get_util(valmat);              // utility at initial stage
-  utilvec(0) = maxutil;
+  utilvec.set(0, maxutil);
   arma::vec setvals = arma::diagvec(valmat);      // current value of each set
+  arma::vec setcomp = arma::zeros(n_persons);     // rounding errors of the updates of setvals
+  int resync = std::max(resync_every, n_items);   // number of iterations between recomputations of setvals
+  double bound = get_util_ub(vals, n_persons);    // upper bound on utility
+  Checkpoint ckpt(checkpoint, every, resume, 2);
 
   // iterate
   int iter = 0;
   bool converged = false;
   int status = 1;
   int noimprove = 0;
+
+  // resume from a checkpoint - setvals takes the place of valmat, and state is released before
+  // iterating
+  {
+    CheckpointState state = {alloc, arma::mat(setvals), arma::mat(setcomp), maxutil, 0, 0,
+                             arma::ivec(), {}};
+    if (ckpt.load(state, maxiter)) {
+      owners = Owners(state.alloc, n_persons);
+      setvals = state.valmat;
+      setcomp = state.valcomp;
+      maxutil = state.obj;
+      iter = state.iter;
+      noimprove = state.noimprove;
+      utilvec.set(0, 0.0);
+      utilvec.set(iter, maxutil);
+    }
+  }
+
   while (iter < maxiter && !converged) {
 
     // sample items to give to a different owner
@@ -230,20 +397,20 @@ List localtrades_utility(arma::mat vals, arma::ivec alloc, int maxiter, int maxn
     int addperson = arma::randi(1, arma::distr_param(1, n_persons - 1))(0);
 
     // try the reassignment and update if improvements are made
-    arma::ivec alloctemp = alloc - 1;
-    int oldperson = alloctemp(item);
+    int oldperson = owners(item);
     int newperson = (oldperson + addperson) % n_persons;
     arma::vec setvalstemp = setvals;
     setvalstemp(oldperson) -= vals(oldperson, item);
     setvalstemp(newperson) += vals(newperson, item);
     double utiltemp = arma::prod(setvalstemp);
-    utilvec(1 + iter) = utiltemp;
+    utilvec.set(1 + iter, utiltemp);
 
     // update if higher utility
     if (utiltemp > maxutil) {
       maxutil = utiltemp;
-      alloc(item) = newperson + 1;
-      setvals = setvalstemp;
+      owners.set(item, newperson);
+      kahan_add(setvals(oldperson), setcomp(oldperson), -vals(oldperson, item));
+      kahan_add(setvals(newperson), setcomp(newperson), vals(newperson, item));
       noimprove = 0;
     } else {
       noimprove++;
@@ -254,21 +421,41 @@ List localtrades_utility(arma::mat vals, arma::ivec alloc, int maxiter, int maxn
     //   converged = true;
     //   status = 0;
     // }
-    if (noimprove >= maxnoimprove) {
+    if (get_gap(maxutil, bound) < reltol) {
+      converged = true;
+      status = 4;
+    } else if (noimprove >= maxnoimprove) {
       converged = true;
       status = 2;
     }
 
     iter++;
+
+    // recompute setvals from the allocation - there is no cheap check for drift, the cost of
+    // get_valmat is spread over at least n_items iterations
+    if (iter % resync == 0) {
+      setvals = arma::diagvec(get_valmat(vals, owners, n_items, n_persons));
+      setcomp.zeros();
+      maxutil = arma::prod(setvals);
+    }
+    if (ckpt.due(iter) && !converged) {
+      ckpt.save(CheckpointState{owners.alloc(), arma::mat(setvals), arma::mat(setcomp), maxutil, iter,
+                                noimprove, arma::ivec(), {}});
+    }
   }
+  ckpt.finish();
 
   List out;
-  out["alloc"] = alloc;
+  out["alloc"] = owners.alloc();
   out["maxutil"] = maxutil;
-  out["valmat"] = get_valmat(vals, alloc, n_items, n_persons);
-  out["utilvec"] = utilvec;
+  if (!compact) {
+    out["valmat"] = get_valmat(vals, owners, n_items, n_persons);
+    out["utilvec"] = utilvec.values;
+  }
   out["status"] = status;
   out["iter"] = iter;
+  out["bound"] = bound;
+  out["gap"] = get_gap(maxutil, bound);
   
   return out;
 }
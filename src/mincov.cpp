@@ -1,186 +1,384 @@
 #include "RcppArmadillo.h"
 #include "helper.h"
+#include "checkpoint.h"
 
 
 // [[Rcpp::depends(RcppArmadillo)]]
 using namespace Rcpp;
 
 
+arma::ivec mincov_aux(int nchanges, int nchecked, const arma::ivec& checked, const arma::uvec& order) {
+  // solver specific state of mincov and mincovtarget in a checkpoint
+  int n_items = checked.n_elem;
+  arma::ivec aux(2 + 2 * n_items);
+  aux(0) = nchanges;
+  aux(1) = nchecked;
+  aux.subvec(2, n_items + 1) = checked;
+  aux.subvec(n_items + 2, 2 * n_items + 1) = arma::conv_to<arma::ivec>::from(order);
+  return aux;
+}
+
+
+arma::vec get_rinv(const arma::mat& vals) {
+  // reciprocals of the valuations of the first person, zero where these are zero, such that
+  // beta(jj, item) = vals(jj, item) * rinv(item) for jj > 0 and beta(0, item) = 1
+  arma::vec rinv(vals.n_cols);
+  for (arma::uword ii = 0; ii < vals.n_cols; ii++) {
+    rinv(ii) = vals(0, ii) != 0.0 ? 1.0 / vals(0, ii) : 0.0;
+    if (!std::isfinite(rinv(ii))) rinv(ii) = 0.0;
+  }
+  return rinv;
+}
+
+
 // [[Rcpp::export]]
-List mincov(arma::mat vals, arma::ivec alloc, arma::mat beta, int maxiter, int maxnoimprove, double eps) {
+List mincov(const arma::mat& vals, const arma::ivec& alloc, int maxiter, int maxnoimprove, double eps,
+            int sweep, double reltol, std::string checkpoint, int every, bool resume, bool compact) {
   // mincov algorithm - randomly choose a column (item) and give it to the person (row) that should 
   // receive it according to the theorem in the paper. This is done a maximum of maxiter steps, 
   // until a social inequality of eps, or until there is no improvement for maxnoimprove steps.
+  // The betas of the items with respect to the first person are computed when the item is visited.
+  // The algorithm also stops as soon as every item has been checked without a reassignment since the
+  // last change, in which case alloc is a fixed point of the mincov rule.
   // 
   // arguments:
   // vals     : matrix (n_persons x n_items) with each row the valuation of that person for the items
   // alloc    : index of the person to which each item belongs
-  // beta     : beta of each person and item with respect to the first person
   // maxiter  : maximum number of iterations
   // maxnoimprove : terminate if no improvement for maxnoimprove consecutive steps
   // eps      : terminate if maxenvy < eps
+  // sweep    : order in which items are visited: 0 (uniformly at random), 1 (cyclic), 2 (cyclic over
+  //            a new random permutation in every pass); when sweeping, only reassignments count
+  //            towards maxnoimprove
+  // reltol   : terminate if the relative gap to the lower bound is below reltol
+  // checkpoint : file to which the state is written every 'every' iterations, empty for none
+  // every    : number of iterations between checkpoints
+  // resume   : continue from checkpoint if it exists, the trace then starts at its iteration
+  // compact  : leave valmat and the trace out of the output
   //
   // output:
   // alloc    : optimal allocation
   // minsoc   : optimal value of social inequality - corresponds to alloc
-  // valmat   : valuation matrix of the different sets (columns) to each person (row)
-  // socvec   : vector with social inequality values at the different iterations
-  // status   : 0 (V < eps); 1 (maxiter reached)
+  // valmat   : valuation matrix of the different sets (columns) to each person (row), not if compact
+  // socvec   : vector with social inequality values at the different iterations, not if compact
+  // status   : 0 (V < eps); 1 (maxiter reached); 2 (no improvement); 3 (fixed point reached);
+  //            4 (gap < reltol)
   // iter     : number of iterations the algorithm completed before stopping
+  // bound    : lower bound on the optimal value
+  // gap      : relative gap between the final objective value and bound
   //
   // author: Dries Cornilly
   
   // initialize
   int n_items = vals.n_cols;                      // number of items to distribute
   int n_persons = vals.n_rows;                    // number of persons to distribute among
-  arma::mat valmat = get_valmat(vals, alloc, n_items, n_persons); // get value of each set of items for each person
+  Owners owners(alloc, n_persons);                // 0-based allocation
+  arma::mat valmat = get_valmat(vals, owners, n_items, n_persons); // get value of each set of items for each person
   arma::mat avgval = get_avgval(vals, n_persons); // initialize average valuations
-  arma::vec socvec = arma::zeros(maxiter + 1);    // initialize social inequality through iterations
-  socvec(0) = get_fnV(valmat, n_persons, avgval);
+  double soc = get_fnV(valmat, n_persons, avgval); // current social inequality
+  Trace socvec(maxiter + 1, !compact);            // initialize social inequality through iterations
+  socvec.set(0, soc);
+  double bound = get_fnV_lb(vals, n_persons);     // lower bound on social inequality
+  arma::mat valcomp = arma::zeros(n_persons, n_persons); // rounding errors of the updates of valmat
+  arma::vec totals = arma::sum(vals, 1);          // row sums of valmat
+  arma::vec scale = arma::sum(arma::abs(vals), 1); // scale of the rounding errors in totals
+
+  arma::uvec order = arma::regspace<arma::uvec>(0, n_items - 1); // visiting order when sweeping
+  arma::ivec checked = arma::zeros<arma::ivec>(n_items); // last change after which each item was checked
+  arma::vec rinv = get_rinv(vals);                // reciprocals of the valuations of the first person
+  arma::vec betacol(n_persons);                   // beta of each person for the current item
+  int nchanges = 1;                               // number of reassignments so far (plus one)
+  int nchecked = 0;                               // number of distinct items checked since the last change
+  Checkpoint ckpt(checkpoint, every, resume, 3);
 
   // iterate
   int iter = 0;
   bool converged = false;
   int status = 1;
   int noimprove = 0;
+
+  // resume from a checkpoint - state is released before iterating
+  {
+    CheckpointState state = {alloc, valmat, valcomp, soc, 0, 0,
+                             mincov_aux(nchanges, nchecked, checked, order), {}};
+    if (ckpt.load(state, maxiter)) {
+      owners = Owners(state.alloc, n_persons);
+      valmat = state.valmat;
+      valcomp = state.valcomp;
+      iter = state.iter;
+      noimprove = state.noimprove;
+      nchanges = state.aux(0);
+      nchecked = state.aux(1);
+      checked = state.aux.subvec(2, n_items + 1);
+      order = arma::conv_to<arma::uvec>::from(state.aux.subvec(n_items + 2, 2 * n_items + 1));
+      soc = state.obj;
+      socvec.set(0, 0.0);
+      socvec.set(iter, soc);
+    }
+  }
+
   while (iter < maxiter && !converged) {
 
-    // sample item and get its owner
-    int item = arma::randi(1, arma::distr_param(0, n_items - 1))(0);
-    int oldperson = alloc(item) - 1;
+    // sample or sweep item and get its owner
+    int item;
+    if (sweep == 0) {
+      item = arma::randi(1, arma::distr_param(0, n_items - 1))(0);
+    } else {
+      if (sweep == 2 && iter % n_items == 0) order = arma::shuffle(order);
+      item = order(iter % n_items);
+    }
+    int oldperson = owners(item);
 
-    // determine whom to give it to
-    arma::mat valmattemp = valmat;
-    valmattemp.col(oldperson) -= vals.col(item);
-    for (int jj = 0; jj < n_persons; jj++) valmattemp.row(jj) *= beta(jj, item);
-    arma::rowvec L = arma::sum(valmattemp, 0);
+    // determine whom to give it to - the beta-weighted value of each set without the item
+    betacol(0) = 1.0;
+    for (int jj = 1; jj < n_persons; jj++) betacol(jj) = vals(jj, item) * rinv(item);
+    arma::rowvec L = get_wsums(betacol, valmat);
+    L(oldperson) -= arma::dot(betacol, vals.col(item));
     int newperson = arma::index_min(L);
 
-    // give item
-    valmat.col(oldperson) -= vals.col(item);
-    valmat.col(newperson) += vals.col(item);
-    alloc(item) = newperson + 1;
-    socvec(1 + iter) = get_fnV(valmat, n_persons, avgval);
-    if (socvec(1 + iter) < socvec(iter)) {
+    // give item - the choice for an item that was just moved does not depend on where it is, so
+    // it counts as checked
+    if (newperson != oldperson) {
+      move_item_comp<0>(valmat, valcomp, vals, item, oldperson, newperson, n_persons);
+      owners.set(item, newperson);
+      nchanges++;
+      nchecked = 0;
+    }
+    if (checked(item) != nchanges) {
+      checked(item) = nchanges;
+      nchecked++;
+    }
+
+    // resynchronize valmat with the allocation if it drifted
+    if ((iter + 1) % resync_every == 0 && get_drift(valmat, totals, scale)) {
+      valmat = get_valmat(vals, owners, n_items, n_persons);
+      valcomp.zeros();
+    }
+    double soctemp = get_fnV(valmat, n_persons, avgval);
+    socvec.set(1 + iter, soctemp);
+    if (soctemp < soc) {
       noimprove = 0;
-    } else {
+    } else if (sweep == 0 || newperson != oldperson) {
       noimprove++;
     }
+    soc = soctemp;
 
     // check convergence
-    if (socvec(1 + iter) < eps) {
+    if (soc < eps) {
       converged = true;
       status = 0;
+    } else if (get_gap(soc, bound) < reltol) {
+      converged = true;
+      status = 4;
+    } else if (nchecked == n_items) {
+      converged = true;
+      status = 3;
     } else if (noimprove >= maxnoimprove) {
       converged = true;
       status = 2;
     }
 
     iter++;
+    if (ckpt.due(iter) && !converged) {
+      ckpt.save(CheckpointState{owners.alloc(), valmat, valcomp, soc, iter, noimprove,
+                                mincov_aux(nchanges, nchecked, checked, order), {}});
+    }
   }
+  ckpt.finish();
 
   List out;
-  out["alloc"] = alloc;
-  out["minsoc"] = socvec(iter);
-  out["valmat"] = valmat;
-  out["socvec"] = socvec;
+  out["alloc"] = owners.alloc();
+  out["minsoc"] = soc;
+  if (!compact) {
+    out["valmat"] = valmat;
+    out["socvec"] = socvec.values;
+  }
   out["status"] = status;
   out["iter"] = iter;
+  out["bound"] = bound;
+  out["gap"] = get_gap(soc, bound);
   
   return out;
 }
 
 
 // [[Rcpp::export]]
-List mincovtarget(arma::mat vals, arma::ivec alloc, arma::mat beta, arma::vec target, 
-                  int maxiter, int maxnoimprove, double eps) {
+List mincovtarget(const arma::mat& vals, const arma::ivec& alloc, arma::vec target, int maxiter,
+                  int maxnoimprove, double eps, int sweep, double reltol, std::string checkpoint,
+                  int every, bool resume, bool compact) {
   // mincov algorithm with target value - randomly choose a column (item) and give it to the person (row) 
   // that should receive it according to the theorem in the paper. This is done a maximum of maxiter steps, 
   // until a social inequality of eps, or until there is no improvement for maxnoimprove steps.
+  // The betas of the items with respect to the first person are computed when the item is visited.
+  // The algorithm also stops as soon as every item has been checked without a reassignment since the
+  // last change, in which case alloc is a fixed point of the mincov rule.
   // 
   // arguments:
   // vals     : matrix (n_persons x n_items) with each row the valuation of that person for the items
   // alloc    : index of the person to which each item belongs
-  // beta     : beta of each person and item with respect to the first person
   // target   : target value for each of the persons
   // maxiter  : maximum number of iterations
   // maxnoimprove : terminate if no improvement for maxnoimprove consecutive steps
   // eps      : terminate if maxenvy < eps
+  // sweep    : order in which items are visited: 0 (uniformly at random), 1 (cyclic), 2 (cyclic over
+  //            a new random permutation in every pass); when sweeping, only reassignments count
+  //            towards maxnoimprove
+  // reltol   : terminate if the relative gap to the lower bound is below reltol
+  // checkpoint : file to which the state is written every 'every' iterations, empty for none
+  // every    : number of iterations between checkpoints
+  // resume   : continue from checkpoint if it exists, the trace then starts at its iteration
+  // compact  : leave valmat and the trace out of the output
   //
   // output:
   // alloc    : optimal allocation
   // minsoc   : optimal value of social inequality - corresponds to alloc
-  // valmat   : valuation matrix of the different sets (columns) to each person (row)
-  // socvec   : vector with social inequality values at the different iterations
-  // status   : 0 (V < eps); 1 (maxiter reached)
+  // valmat   : valuation matrix of the different sets (columns) to each person (row), not if compact
+  // socvec   : vector with social inequality values at the different iterations, not if compact
+  // status   : 0 (V < eps); 1 (maxiter reached); 2 (no improvement); 3 (fixed point reached);
+  //            4 (gap < reltol)
   // iter     : number of iterations the algorithm completed before stopping
+  // bound    : lower bound on the optimal value
+  // gap      : relative gap between the final objective value and bound
   //
   // author: Dries Cornilly
   
   // initialize
   int n_items = vals.n_cols;                      // number of items to distribute
   int n_persons = vals.n_rows;                    // number of persons to distribute among
-  arma::mat valmatT = get_valmat(vals, alloc, n_items, n_persons); // get value of each set of items for each person
+  Owners owners(alloc, n_persons);                // 0-based allocation
+  arma::mat valmatT = get_valmat(vals, owners, n_items, n_persons); // get value of each set of items for each person
   valmatT.diag() -= target;
   arma::mat avgval = get_avgval(valmatT, n_persons); // initialize average valuations
-  arma::vec socvec = arma::zeros(maxiter + 1);    // initialize social inequality through iterations
-  socvec(0) = get_fnV(valmatT, n_persons, avgval);
+  double soc = get_fnV(valmatT, n_persons, avgval); // current social inequality
+  Trace socvec(maxiter + 1, !compact);            // initialize social inequality through iterations
+  socvec.set(0, soc);
+  double bound = 0.0;                             // no cheap bound with target values
+  arma::mat valcomp = arma::zeros(n_persons, n_persons); // rounding errors of the updates of valmatT
+  arma::vec totals = arma::sum(vals, 1) - target; // row sums of valmatT
+  arma::vec scale = arma::sum(arma::abs(vals), 1) + arma::abs(target); // scale of the rounding errors in totals
+
+  arma::uvec order = arma::regspace<arma::uvec>(0, n_items - 1); // visiting order when sweeping
+  arma::ivec checked = arma::zeros<arma::ivec>(n_items); // last change after which each item was checked
+  arma::vec rinv = get_rinv(vals);                // reciprocals of the valuations of the first person
+  arma::vec betacol(n_persons);                   // beta of each person for the current item
+  int nchanges = 1;                               // number of reassignments so far (plus one)
+  int nchecked = 0;                               // number of distinct items checked since the last change
+  Checkpoint ckpt(checkpoint, every, resume, 4);
 
   // iterate
   int iter = 0;
   bool converged = false;
   int status = 1;
   int noimprove = 0;
+
+  // resume from a checkpoint - state is released before iterating
+  {
+    CheckpointState state = {alloc, valmatT, valcomp, soc, 0, 0,
+                             mincov_aux(nchanges, nchecked, checked, order), {}};
+    if (ckpt.load(state, maxiter)) {
+      owners = Owners(state.alloc, n_persons);
+      valmatT = state.valmat;
+      valcomp = state.valcomp;
+      iter = state.iter;
+      noimprove = state.noimprove;
+      nchanges = state.aux(0);
+      nchecked = state.aux(1);
+      checked = state.aux.subvec(2, n_items + 1);
+      order = arma::conv_to<arma::uvec>::from(state.aux.subvec(n_items + 2, 2 * n_items + 1));
+      soc = state.obj;
+      socvec.set(0, 0.0);
+      socvec.set(iter, soc);
+    }
+  }
+
   while (iter < maxiter && !converged) {
     
-    // sample item and get its owner
-    int item = arma::randi(1, arma::distr_param(0, n_items - 1))(0);
-    int oldperson = alloc(item) - 1;
+    // sample or sweep item and get its owner
+    int item;
+    if (sweep == 0) {
+      item = arma::randi(1, arma::distr_param(0, n_items - 1))(0);
+    } else {
+      if (sweep == 2 && iter % n_items == 0) order = arma::shuffle(order);
+      item = order(iter % n_items);
+    }
+    int oldperson = owners(item);
     
-    // determine whom to give it to
-    arma::mat valmattemp = valmatT;
-    valmattemp.col(oldperson) -= vals.col(item);
-    for (int jj = 0; jj < n_persons; jj++) valmattemp.row(jj) *= beta(jj, item);
-    arma::rowvec L = arma::sum(valmattemp, 0);
+    // determine whom to give it to - the beta-weighted value of each set without the item
+    betacol(0) = 1.0;
+    for (int jj = 1; jj < n_persons; jj++) betacol(jj) = vals(jj, item) * rinv(item);
+    arma::rowvec L = get_wsums(betacol, valmatT);
+    L(oldperson) -= arma::dot(betacol, vals.col(item));
     int newperson = arma::index_min(L);
     
-    // give item
-    valmatT.col(oldperson) -= vals.col(item);
-    valmatT.col(newperson) += vals.col(item);
-    alloc(item) = newperson + 1;
-    socvec(1 + iter) = get_fnV(valmatT, n_persons, avgval);
-    if (socvec(1 + iter) < socvec(iter)) {
+    // give item - the choice for an item that was just moved does not depend on where it is, so
+    // it counts as checked
+    if (newperson != oldperson) {
+      move_item_comp<0>(valmatT, valcomp, vals, item, oldperson, newperson, n_persons);
+      owners.set(item, newperson);
+      nchanges++;
+      nchecked = 0;
+    }
+    if (checked(item) != nchanges) {
+      checked(item) = nchanges;
+      nchecked++;
+    }
+
+    // resynchronize valmatT with the allocation if it drifted
+    if ((iter + 1) % resync_every == 0 && get_drift(valmatT, totals, scale)) {
+      valmatT = get_valmat(vals, owners, n_items, n_persons);
+      valmatT.diag() -= target;
+      valcomp.zeros();
+    }
+    double soctemp = get_fnV(valmatT, n_persons, avgval);
+    socvec.set(1 + iter, soctemp);
+    if (soctemp < soc) {
       noimprove = 0;
-    } else {
+    } else if (sweep == 0 || newperson != oldperson) {
       noimprove++;
     }
+    soc = soctemp;
     
     // check convergence
-    if (socvec(1 + iter) < eps) {
+    if (soc < eps) {
       converged = true;
       status = 0;
+    } else if (get_gap(soc, bound) < reltol) {
+      converged = true;
+      status = 4;
+    } else if (nchecked == n_items) {
+      converged = true;
+      status = 3;
     } else if (noimprove >= maxnoimprove) {
       converged = true;
       status = 2;
     }
 
     iter++;
+    if (ckpt.due(iter) && !converged) {
+      ckpt.save(CheckpointState{owners.alloc(), valmatT, valcomp, soc, iter, noimprove,
+                                mincov_aux(nchanges, nchecked, checked, order), {}});
+    }
   }
+  ckpt.finish();
   
   // compute end-statistics without the target columns
-  arma::mat valmat0 = get_valmat(vals, alloc, n_items, n_persons);
+  arma::mat valmat0 = get_valmat(vals, owners, n_items, n_persons);
   arma::mat avgval0 = get_avgval(valmat0, n_persons);
   double minsoc0 = get_fnV(valmat0, n_persons, avgval0);
   
   List out;
-  out["alloc"] = alloc;
-  out["minsocT"] = socvec(iter);
+  out["alloc"] = owners.alloc();
+  out["minsocT"] = soc;
   out["minsoc"] = minsoc0;
-  out["valmatT"] = valmatT;
-  out["valmat"] = valmat0;
-  out["socvec"] = socvec;
+  if (!compact) {
+    out["valmatT"] = valmatT;
+    out["valmat"] = valmat0;
+    out["socvec"] = socvec.values;
+  }
   out["status"] = status;
   out["iter"] = iter;
+  out["bound"] = bound;
+  out["gap"] = get_gap(soc, bound);
   
   return out;
 }
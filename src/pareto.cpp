@@ -0,0 +1,195 @@
+#include "RcppArmadillo.h"
+#include "helper.h"
+
+
+// [[Rcpp::depends(RcppArmadillo)]]
+using namespace Rcpp;
+
+
+bool dominates(const arma::vec& a, const arma::vec& b) {
+  // checks whether objective vector a dominates b, all objectives are minimized
+  return arma::all(a <= b) && arma::any(a < b);
+}
+
+
+struct Archive {
+  // bounded archive of mutually non-dominated allocations - objectives are maxenvy, social
+  // inequality and minus the utility, all to be minimized
+  int capacity;                                   // maximum number of allocations
+  std::vector<Owners> alloc;                      // allocations in the archive
+  std::vector<arma::vec> obj;                     // objective vectors of the allocations
+
+  bool insert(const Owners& a, const arma::vec& o) {
+    // adds an allocation unless it is dominated by (or equal to) a member, and removes the members
+    // it dominates - returns whether it is in the archive afterwards
+    for (size_t kk = 0; kk < obj.size(); kk++) {
+      if (dominates(obj[kk], o) || arma::all(obj[kk] == o)) return false;
+    }
+    for (size_t kk = 0; kk < obj.size(); ) {
+      if (dominates(o, obj[kk])) {
+        std::swap(alloc[kk], alloc.back());
+        std::swap(obj[kk], obj.back());
+        alloc.pop_back();
+        obj.pop_back();
+      } else {
+        kk++;
+      }
+    }
+    alloc.push_back(a);
+    obj.push_back(o);
+    int m = obj.size();
+    if (m <= capacity) return true;
+    return evict() != m - 1;
+  }
+
+  int evict() {
+    // removes the member with the closest neighbour in the objective space, normalized by the range
+    // of each objective; the best member for each objective is never removed - returns the position
+    // of the removed member
+    int m = obj.size();
+    arma::mat o(3, m);
+    for (int kk = 0; kk < m; kk++) o.col(kk) = obj[kk];
+    arma::vec lo = arma::min(o, 1);
+    arma::vec range = arma::max(o, 1) - lo;
+    for (int ll = 0; ll < 3; ll++) {
+      if (range(ll) > 0.0) {
+        o.row(ll) = (o.row(ll) - lo(ll)) / range(ll);
+      } else {
+        o.row(ll).zeros();
+      }
+    }
+
+    int worst = -1;
+    double mindist = arma::datum::inf;
+    for (int kk = 0; kk < m; kk++) {
+      if (arma::any(o.col(kk) == 0.0)) continue;
+      for (int ll = 0; ll < m; ll++) {
+        if (ll == kk) continue;
+        double dist = arma::accu(arma::square(o.col(kk) - o.col(ll)));
+        if (dist < mindist) {
+          mindist = dist;
+          worst = kk;
+        }
+      }
+    }
+    if (worst < 0) worst = m - 1;
+
+    std::swap(alloc[worst], alloc.back());
+    std::swap(obj[worst], obj.back());
+    alloc.pop_back();
+    obj.pop_back();
+    return worst;
+  }
+};
+
+
+// [[Rcpp::export]]
+List localtrades_pareto(arma::mat vals, const arma::ivec& alloc, int archsize, int maxiter,
+                        int maxnoimprove) {
+  // Pareto local search over maxenvy, social inequality and utility - randomly choose an item and
+  // allocate it to a different person, and accept the move unless the new allocation is dominated
+  // by the current one. Accepted allocations are offered to a bounded archive of non-dominated
+  // allocations, which evicts the most crowded member when it is full. This is done a maximum of
+  // maxiter steps, or until the archive did not change for maxnoimprove steps.
+  //
+  // arguments:
+  // vals     : matrix (n_persons x n_items) with each row the valuation of that person for the items
+  // alloc    : index of the person to which each item belongs
+  // archsize : maximum number of allocations in the archive
+  // maxiter  : maximum number of iterations
+  // maxnoimprove : terminate if the archive did not change for maxnoimprove consecutive steps
+  //
+  // output:
+  // alloc    : matrix (n_items x size of the archive) with the allocations of the archive
+  // front    : matrix (size of the archive x 3) with maxenvy, social inequality and utility of these
+  // status   : 1 (maxiter reached); 2 (no improvement)
+  // iter     : number of iterations the algorithm completed before stopping
+  // insertions : number of allocations added to the archive
+  //
+  // author: Dries Cornilly
+
+  // initialize
+  int n_items = vals.n_cols;                      // number of items to distribute
+  int n_persons = vals.n_rows;                    // number of persons to distribute among
+  Owners owners(alloc, n_persons);                // 0-based allocation
+  arma::mat valmat = get_valmat(vals, owners, n_items, n_persons); // get value of each set of items for each person
+  arma::mat valmattemp = valmat;                  // workspace for the proposed reassignment
+  arma::mat valcomp = arma::zeros(n_persons, n_persons); // rounding errors of the updates of valmat
+  arma::vec totals = arma::sum(vals, 1);          // row sums of valmat
+  arma::vec scale = arma::sum(arma::abs(vals), 1); // scale of the rounding errors in totals
+  arma::mat avgval = get_avgval(vals, n_persons); // initialize average valuations
+  arma::vec sign = {1.0, 1.0, -1.0};              // utility is maximized
+  arma::vec cur = get_objectives(valmat, n_persons, avgval) % sign;
+
+  Archive archive;
+  archive.capacity = std::max(archsize, 1);
+  archive.insert(owners, cur);
+  int insertions = 1;
+
+  // iterate
+  int iter = 0;
+  bool converged = false;
+  int status = 1;
+  int noimprove = 0;
+  while (iter < maxiter && !converged) {
+
+    // sample items to give to a different owner
+    int item = arma::randi(1, arma::distr_param(0, n_items - 1))(0);
+    int addperson = arma::randi(1, arma::distr_param(1, n_persons - 1))(0);
+
+    // evaluate all objectives of the reassignment in one pass
+    int oldperson = owners(item);
+    int newperson = (oldperson + addperson) % n_persons;
+    valmattemp = valmat;
+    move_item<0>(valmattemp, vals, item, oldperson, newperson, n_persons);
+    arma::vec objtemp = get_objectives(valmattemp, n_persons, avgval) % sign;
+
+    // move unless dominated, and offer the new allocation to the archive
+    noimprove++;
+    if (!dominates(cur, objtemp)) {
+      cur = objtemp;
+      owners.set(item, newperson);
+      move_item_comp<0>(valmat, valcomp, vals, item, oldperson, newperson, n_persons);
+      if (archive.insert(owners, cur)) {
+        insertions++;
+        noimprove = 0;
+      }
+    }
+
+    // check convergence
+    if (noimprove >= maxnoimprove) {
+      converged = true;
+      status = 2;
+    }
+
+    iter++;
+
+    // resynchronize valmat with the allocation if it drifted
+    if (iter % resync_every == 0 && get_drift(valmat, totals, scale)) {
+      valmat = get_valmat(vals, owners, n_items, n_persons);
+      valcomp.zeros();
+      cur = get_objectives(valmat, n_persons, avgval) % sign;
+    }
+  }
+
+  // collect the archive, sorted on maxenvy
+  int m = archive.obj.size();
+  arma::vec envy(m);
+  for (int kk = 0; kk < m; kk++) envy(kk) = archive.obj[kk](0);
+  arma::uvec idx = arma::sort_index(envy);
+  arma::imat allocs(n_items, m);
+  arma::mat front(m, 3);
+  for (int kk = 0; kk < m; kk++) {
+    allocs.col(kk) = archive.alloc[idx(kk)].alloc();
+    front.row(kk) = (archive.obj[idx(kk)] % sign).t();
+  }
+
+  List out;
+  out["alloc"] = allocs;
+  out["front"] = front;
+  out["status"] = status;
+  out["iter"] = iter;
+  out["insertions"] = insertions;
+
+  return out;
+}
@@ -0,0 +1,180 @@
+#include "RcppArmadillo.h"
+#include "helper.h"
+#include <mutex>
+#include <random>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+
+// [[Rcpp::depends(RcppArmadillo)]]
+using namespace Rcpp;
+
+
+// [[Rcpp::export]]
+List localtrades_social_par(arma::mat vals, const arma::ivec& alloc, int n_threads, int sync,
+                            int maxiter, int maxnoimprove, double eps, double reltol, bool compact) {
+  // concurrent social inequality-swapping algorithm for a single instance - the items are split
+  // over the threads in contiguous blocks, and each thread randomly chooses one of its own items
+  // and allocates it to a different person if it decreases the social inequality objective. Such a
+  // move only touches the columns of the old and the new owner in the shared valmat, which are
+  // locked (in increasing order) while the move is scored and applied with compensated summation,
+  // such that moves on other pairs of persons proceed concurrently. The threads synchronize after
+  // every sync moves each, and the objective and convergence criteria are evaluated at these
+  // points, after valmat is resynchronized with the allocation if it drifted. This is done a
+  // maximum of maxiter moves in total, until a social inequality of eps is reached, or until there
+  // is no improvement for maxnoimprove moves.
+  //
+  // arguments:
+  // vals     : matrix (n_persons x n_items) with each row the valuation of that person for the items
+  // alloc    : index of the person to which each item belongs
+  // n_threads : number of threads (only when compiled with OpenMP)
+  // sync     : number of moves of each thread between synchronizations
+  // maxiter  : maximum number of moves over all threads
+  // maxnoimprove : terminate if no improvement for maxnoimprove consecutive moves (at synchronization)
+  // eps      : terminate if soc_ineq < eps
+  // reltol   : terminate if the relative gap to the lower bound is below reltol
+  // compact  : leave valmat and the trace out of the output
+  //
+  // output:
+  // alloc    : optimal allocation
+  // minsoc   : optimal value of social inequality - corresponds to alloc
+  // valmat   : valuation matrix of the different sets (columns) to each person (row), not if compact
+  // socvec   : vector with social inequality values at the different synchronizations, not if compact
+  // status   : 0 (V < eps); 1 (maxiter reached); 2 (no improvement); 4 (gap < reltol)
+  // iter     : number of moves the algorithm completed before stopping
+  // bound    : lower bound on the optimal value
+  // gap      : relative gap between the final objective value and bound
+  //
+  // author: Dries Cornilly
+
+  // initialize
+  if (n_threads < 1) stop("n_threads must be at least 1.");
+  if (sync < 1) stop("sync must be at least 1.");
+  int n_items = vals.n_cols;                      // number of items to distribute
+  int n_persons = vals.n_rows;                    // number of persons to distribute among
+#ifdef _OPENMP
+  n_threads = std::max(1, std::min(n_threads, std::min(n_items, omp_get_max_threads())));
+#else
+  n_threads = 1;
+#endif
+  arma::mat avgval = get_avgval(vals, n_persons); // initialize average valuations
+  Owners owner(alloc, n_persons);                 // 0-based allocation, split in n_threads blocks of items
+  arma::mat valmat = get_valmat(vals, owner, n_items, n_persons); // get value of each set of items for each person
+  double soc = get_fnV(valmat, n_persons, avgval); // current social inequality
+  Trace socvec(maxiter / sync / n_threads + 2, !compact); // social inequality at the synchronizations
+  socvec.set(0, soc);
+  double bound = get_fnV_lb(vals, n_persons);     // lower bound on social inequality
+  arma::mat valcomp = arma::zeros(n_persons, n_persons); // rounding errors of the updates of valmat
+  arma::vec totals = arma::sum(vals, 1);          // row sums of valmat
+  arma::vec scale = arma::sum(arma::abs(vals), 1); // scale of the rounding errors in totals
+  arma::ivec seeds = arma::randi(n_threads, arma::distr_param(0, 2147483646));
+  std::vector<std::mt19937_64> rng(n_threads);    // one random number generator per block, for all rounds
+  for (int kk = 0; kk < n_threads; kk++) rng[kk].seed(seeds(kk));
+  std::vector<std::mutex> locks(n_persons);       // one lock per column of valmat and valcomp
+
+  // iterate in rounds between synchronizations
+  int iter = 0;
+  int nsync = 0;
+  bool converged = false;
+  int status = 1;
+  int noimprove = 0;
+  while (iter < maxiter && !converged) {
+    int moves = std::min(sync, (maxiter - iter + n_threads - 1) / n_threads); // moves of each block
+    int accepted = 0;
+    int attempted = 0;
+
+    #pragma omp parallel num_threads(n_threads) reduction(+:accepted, attempted)
+    {
+      int worker = 0;
+      int team = 1;
+#ifdef _OPENMP
+      worker = omp_get_thread_num();
+      team = omp_get_num_threads();
+#endif
+
+      // the runtime may start fewer threads than requested, each thread then moves several blocks
+      for (int blk = worker; blk < n_threads; blk += team) {
+        int lo = (long) n_items * blk / n_threads; // first item of the block
+        int n_own = (long) n_items * (blk + 1) / n_threads - lo;
+        std::uniform_int_distribution<int> itemdist(0, std::max(n_own - 1, 0));
+        std::uniform_int_distribution<int> adddist(1, n_persons - 1);
+
+        int ii = 0;
+        for (; ii < moves && n_own > 0; ii++) {
+
+          // sample one of the own items to give to a different owner
+          int item = lo + itemdist(rng[blk]);
+          int oldperson = owner(item);
+          int newperson = (oldperson + adddist(rng[blk])) % n_persons;
+          int first = std::min(oldperson, newperson);
+          int second = std::max(oldperson, newperson);
+
+          // score the reassignment on the locked columns - the change in the sum of squared
+          // deviations equals 2 * sum(v % (newcol - oldcol + v))
+          locks[first].lock();
+          locks[second].lock();
+          const double* v = vals.colptr(item);
+          const double* oldcol = valmat.colptr(oldperson);
+          const double* newcol = valmat.colptr(newperson);
+          double delta = 0.0;
+          for (int kk = 0; kk < n_persons; kk++) delta += v[kk] * (newcol[kk] - oldcol[kk] + v[kk]);
+          if (delta < 0.0) {
+            move_item_comp<0>(valmat, valcomp, vals, item, oldperson, newperson, n_persons);
+            owner.set(item, newperson);
+            accepted++;
+          }
+          locks[second].unlock();
+          locks[first].unlock();
+        }
+        attempted += ii;
+      }
+    }
+
+    // all threads are quiescent - resynchronize valmat with the allocation if it drifted, and
+    // evaluate the allocation
+    iter += attempted;
+    nsync++;
+    if (get_drift(valmat, totals, scale)) {
+      valmat = get_valmat(vals, owner, n_items, n_persons);
+      valcomp.zeros();
+    }
+    soc = get_fnV(valmat, n_persons, avgval);
+    socvec.set(nsync, soc);
+    if (accepted > 0) {
+      noimprove = 0;
+    } else {
+      noimprove += attempted;
+    }
+
+    // check convergence
+    if (soc < eps) {
+      converged = true;
+      status = 0;
+    } else if (get_gap(soc, bound) < reltol) {
+      converged = true;
+      status = 4;
+    } else if (noimprove >= maxnoimprove) {
+      converged = true;
+      status = 2;
+    }
+  }
+
+  // recompute valmat from the allocation, removing the rounding errors of the concurrent updates
+  valmat = get_valmat(vals, owner, n_items, n_persons);
+  double minsoc = get_fnV(valmat, n_persons, avgval);
+
+  List out;
+  out["alloc"] = owner.alloc();
+  out["minsoc"] = minsoc;
+  if (!compact) {
+    out["valmat"] = valmat;
+    out["socvec"] = arma::vec(socvec.values.head(nsync + 1));
+  }
+  out["status"] = status;
+  out["iter"] = std::min(iter, maxiter);
+  out["bound"] = bound;
+  out["gap"] = get_gap(minsoc, bound);
+
+  return out;
+}
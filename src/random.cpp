@@ -1,11 +1,86 @@
 #include "RcppArmadillo.h"
 #include "helper.h"
+#include <utility>
 
 
 // [[Rcpp::depends(RcppArmadillo)]]
 using namespace Rcpp;
 
 
+struct WalkLog {
+  // items reassigned by the random walk since its best allocation, such that an improvement only
+  // updates these items of the best allocation - once more than n_items items are logged, copying
+  // the whole allocation is cheaper
+  std::vector<int> items;
+  bool full = true;                               // the log is not complete, copy on improvement
+
+  void add(int item, int n_items) {
+    if (full) return;
+    items.push_back(item);
+    if ((int) items.size() > n_items) full = true;
+  }
+  void apply(Owners& best, const Owners& current) {
+    if (full) {
+      best = current;
+    } else {
+      for (size_t kk = 0; kk < items.size(); kk++) best.set(items[kk], current(items[kk]));
+    }
+    items.clear();
+    full = false;
+  }
+};
+
+
+void get_rowmax(const arma::mat& valmat, arma::vec& rowmax, arma::ivec& argmax, int n) {
+  // largest value of each row of valmat and its column
+  for (int ii = 0; ii < n; ii++) {
+    rowmax(ii) = valmat(ii, 0);
+    argmax(ii) = 0;
+  }
+  for (int jj = 1; jj < n; jj++) {
+    const double* col = valmat.colptr(jj);
+    for (int ii = 0; ii < n; ii++) {
+      if (col[ii] > rowmax(ii)) {
+        rowmax(ii) = col[ii];
+        argmax(ii) = jj;
+      }
+    }
+  }
+}
+
+
+void update_rowmax(const arma::mat& valmat, arma::vec& rowmax, arma::ivec& argmax, int a, int b, int n) {
+  // updates the row maxima after columns a and b of valmat changed - a row is only rescanned if its
+  // maximum was in one of these columns and decreased
+  for (int ii = 0; ii < n; ii++) {
+    int jj = argmax(ii);
+    if (jj == a || jj == b) {
+      if (valmat(ii, jj) >= rowmax(ii)) {
+        rowmax(ii) = valmat(ii, jj);
+      } else {
+        rowmax(ii) = valmat(ii, 0);
+        argmax(ii) = 0;
+        for (int kk = 1; kk < n; kk++) {
+          if (valmat(ii, kk) > rowmax(ii)) {
+            rowmax(ii) = valmat(ii, kk);
+            argmax(ii) = kk;
+          }
+        }
+        continue;
+      }
+    }
+    if (valmat(ii, a) > rowmax(ii)) {
+      rowmax(ii) = valmat(ii, a);
+      argmax(ii) = a;
+    }
+    if (valmat(ii, b) > rowmax(ii)) {
+      rowmax(ii) = valmat(ii, b);
+      argmax(ii) = b;
+    }
+  }
+}
+
+
 // [[Rcpp::export]]
 arma::ivec random_alloc(int n_items, int n_persons) {
   // generate random allocation of the item to the persons
@@ -25,24 +100,33 @@ arma::ivec random_alloc(int n_items, int n_persons) {
 
 
 // [[Rcpp::export]]
-List randselect_envy(arma::mat vals, int maxiter, int maxnoimprove, double eps) {
+List randselect_envy(arma::mat vals, int walk, int maxiter, int maxnoimprove, double eps, double reltol,
+                     bool compact) {
   // random minmaxenvy algorithm - randomly (uniformly) allocate each item to one of the persons. This
   // is done a maximum of maxiter steps, until a maxenvy of eps is reached, or until there is no 
-  // improvement for maxnoimprove steps.
+  // improvement for maxnoimprove steps. With walk > 0, the samples form a random walk instead, where
+  // each sample reassigns walk random items of the previous one, and valmat and the maximum of each
+  // of its rows are updated incrementally. The best allocation is kept without its valmat, which is
+  // only computed for the output.
   // 
   // arguments:
   // vals     : matrix (n_persons x n_items) with each row the valuation of that person for the items
+  // walk     : 0 for independent samples, otherwise the number of reassignments between samples
   // maxiter  : maximum number of iterations
   // maxnoimprove : terminate if no improvement for maxnoimprove consecutive steps
   // eps      : terminate if maxenvy < eps
+  // reltol   : terminate if the relative gap to the lower bound is below reltol
+  // compact  : leave valmat and the trace out of the output
   //
   // output:
   // alloc    : optimal allocation 
   // minmaxenvy : optimal value of maxenvy - corresponds to alloc
-  // valmat   : valuation matrix of the different sets (columns) to each person (row)
-  // envyvec  : vector with maxenvy values at the different iterations
-  // status   : 0 (V < eps); 1 (maxiter reached)
+  // valmat   : valuation matrix of the different sets (columns) to each person (row), not if compact
+  // envyvec  : vector with maxenvy values at the different iterations, not if compact
+  // status   : 0 (V < eps); 1 (maxiter reached); 2 (no improvement); 4 (gap < reltol)
   // iter     : number of iterations the algorithm completed before stopping
+  // bound    : lower bound on the optimal value
+  // gap      : relative gap between the final objective value and bound
   //
   // author: Dries Cornilly
   
@@ -50,9 +134,17 @@ List randselect_envy(arma::mat vals, int maxiter, int maxnoimprove, double eps)
   int n_items = vals.n_cols;                      // number of items to distribute
   int n_persons = vals.n_rows;                    // number of persons to distribute among
   double minmaxenvy = arma::sum(arma::sum(vals)); // initialize at high value
-  arma::ivec alloc(n_items);
-  arma::mat valmat(n_persons, n_persons);
-  arma::vec envyvec = arma::zeros(maxiter);
+  Owners alloc;                                   // best allocation (0-based)
+  Trace envyvec(maxiter, !compact);
+  double bound = get_maxenvy_lb(vals, n_persons); // lower bound on maxenvy
+  Owners alloctemp;                               // current sample (0-based)
+  arma::mat valmattemp(n_persons, n_persons);     // valuation matrix of the current sample
+  arma::vec rowmax(n_persons);                    // largest value of each row of valmattemp
+  arma::ivec argmax(n_persons);                   // column of the largest value of each row
+  WalkLog moved;                                  // items reassigned since the best allocation
+  arma::mat valcomp = arma::zeros(n_persons, n_persons); // rounding errors of the updates of valmattemp
+  arma::vec totals = arma::sum(vals, 1);          // row sums of valmattemp
+  arma::vec scale = arma::sum(arma::abs(vals), 1); // scale of the rounding errors in totals
   
   // iterate
   int iter = 0;
@@ -61,17 +153,47 @@ List randselect_envy(arma::mat vals, int maxiter, int maxnoimprove, double eps)
   int noimprove = 0;
   while (iter < maxiter && !converged) {
     
-    // give items to random person
-    arma::ivec alloctemp = random_alloc(n_items, n_persons);
-    arma::mat valmattemp = get_valmat(vals, alloctemp, n_items, n_persons);
-    double envytemp = get_maxenvy(valmattemp, n_persons);
-    envyvec(iter) = envytemp;
+    // give items to random person, or reassign walk random items of the previous sample
+    if (walk == 0 || iter == 0) {
+      alloctemp = Owners(random_alloc(n_items, n_persons), n_persons);
+      valmattemp = get_valmat(vals, alloctemp, n_items, n_persons);
+      if (walk > 0) get_rowmax(valmattemp, rowmax, argmax, n_persons);
+    } else {
+      for (int kk = 0; kk < walk; kk++) {
+        int item = arma::randi(1, arma::distr_param(0, n_items - 1))(0);
+        int addperson = arma::randi(1, arma::distr_param(1, n_persons - 1))(0);
+        int oldperson = alloctemp(item);
+        int newperson = (oldperson + addperson) % n_persons;
+        move_item_comp<0>(valmattemp, valcomp, vals, item, oldperson, newperson, n_persons);
+        alloctemp.set(item, newperson);
+        update_rowmax(valmattemp, rowmax, argmax, oldperson, newperson, n_persons);
+        moved.add(item, n_items);
+      }
+      if (iter % resync_every == 0 && get_drift(valmattemp, totals, scale)) {
+        valmattemp = get_valmat(vals, alloctemp, n_items, n_persons);
+        valcomp.zeros();
+        get_rowmax(valmattemp, rowmax, argmax, n_persons);
+      }
+    }
+    double envytemp = 0.0;
+    if (walk == 0) {
+      envytemp = get_maxenvy(valmattemp, n_persons);
+    } else {
+      for (int ii = 0; ii < n_persons; ii++) {
+        envytemp = std::max(envytemp, rowmax(ii) - valmattemp(ii, ii));
+      }
+    }
+    envyvec.set(iter, envytemp);
     
-    // update optimal solution
-    if (envytemp < minmaxenvy) {
+    // update optimal solution - an independent sample is not needed anymore, a walk only updates
+    // the items it reassigned since the last improvement, the first sample is always kept
+    if (iter == 0 || envytemp < minmaxenvy) {
       minmaxenvy = envytemp;
-      alloc = alloctemp;
-      valmat = valmattemp;
+      if (walk == 0) {
+        std::swap(alloc, alloctemp);
+      } else {
+        moved.apply(alloc, alloctemp);
+      }
       noimprove = 0;
     } else {
       noimprove++;
@@ -81,6 +203,9 @@ List randselect_envy(arma::mat vals, int maxiter, int maxnoimprove, double eps)
     if (minmaxenvy < eps) {
       converged = true;
       status = 0;
+    } else if (get_gap(minmaxenvy, bound) < reltol) {
+      converged = true;
+      status = 4;
     } else if (noimprove >= maxnoimprove) {
       converged = true;
       status = 2;
@@ -90,36 +215,49 @@ List randselect_envy(arma::mat vals, int maxiter, int maxnoimprove, double eps)
   }
   
   List out;
-  out["alloc"] = alloc;
+  out["alloc"] = alloc.alloc();
   out["minmaxenvy"] = minmaxenvy;
-  out["valmat"] = valmat;
-  out["envyvec"] = envyvec;
+  if (!compact) {
+    out["valmat"] = get_valmat(vals, alloc, n_items, n_persons);
+    out["envyvec"] = envyvec.values;
+  }
   out["status"] = status;
   out["iter"] = iter;
+  out["bound"] = bound;
+  out["gap"] = get_gap(minmaxenvy, bound);
   
   return out;
 }
 
 
 // [[Rcpp::export]]
-List randselect_social(arma::mat vals, int maxiter, int maxnoimprove, double eps) {
+List randselect_social(arma::mat vals, int walk, int maxiter, int maxnoimprove, double eps,
+                        double reltol, bool compact) {
   // random social inequality algorithm - randomly (uniformly) allocate each item to one of the
   // persons. This is done a maximum of maxiter steps, until a social inequality of eps is reached,
-  // or until there is no improvement for maxnoimprove steps.
+  // or until there is no improvement for maxnoimprove steps. With walk > 0, the samples form a random
+  // walk instead, where each sample reassigns walk random items of the previous one and valmat and
+  // the social inequality are updated incrementally. The best allocation is kept without its valmat,
+  // which is only computed for the output.
   //
   // arguments:
   // vals     : matrix (n_persons x n_items) with each row the valuation of that person for the items
+  // walk     : 0 for independent samples, otherwise the number of reassignments between samples
   // maxiter  : maximum number of iterations
   // maxnoimprove : terminate if no improvement for maxnoimprove consecutive steps
   // eps      : terminate if soc < eps
+  // reltol   : terminate if the relative gap to the lower bound is below reltol
+  // compact  : leave valmat and the trace out of the output
   //
   // output:
   // alloc    : optimal allocation
   // minsoc   : optimal value of social inequality - corresponds to alloc
-  // valmat   : valuation matrix of the different sets (columns) to each person (row)
-  // socvec   : vector with social inequality values at the different iterations
-  // status   : 0 (V < eps); 1 (maxiter reached)
+  // valmat   : valuation matrix of the different sets (columns) to each person (row), not if compact
+  // socvec   : vector with social inequality values at the different iterations, not if compact
+  // status   : 0 (V < eps); 1 (maxiter reached); 2 (no improvement); 4 (gap < reltol)
   // iter     : number of iterations the algorithm completed before stopping
+  // bound    : lower bound on the optimal value
+  // gap      : relative gap between the final objective value and bound
   //
   // author: Dries Cornilly
 
@@ -127,10 +265,18 @@ List randselect_social(arma::mat vals, int maxiter, int maxnoimprove, double eps
   int n_items = vals.n_cols;                      // number of items to distribute
   int n_persons = vals.n_rows;                    // number of persons to distribute among
   double minsoc = arma::sum(arma::sum(vals % vals)); // initialize at high value
-  arma::ivec alloc(n_items);
+  Owners alloc;                                   // best allocation (0-based)
   arma::mat avgval = get_avgval(vals, n_persons);
-  arma::mat valmat(n_persons, n_persons);
-  arma::vec socvec = arma::zeros(maxiter);
+  Trace socvec(maxiter, !compact);
+  double bound = get_fnV_lb(vals, n_persons);     // lower bound on social inequality
+  double nn = 1.0 * n_persons * n_persons;
+  Owners alloctemp;                               // current sample (0-based)
+  arma::mat valmattemp(n_persons, n_persons);     // valuation matrix of the current sample
+  double soctemp = 0.0;                           // social inequality of the current sample
+  arma::mat valcomp = arma::zeros(n_persons, n_persons); // rounding errors of the updates of valmattemp
+  arma::vec totals = arma::sum(vals, 1);          // row sums of valmattemp
+  arma::vec scale = arma::sum(arma::abs(vals), 1); // scale of the rounding errors in totals
+  WalkLog moved;                                  // items reassigned since the best allocation
 
   // iterate
   int iter = 0;
@@ -139,17 +285,47 @@ List randselect_social(arma::mat vals, int maxiter, int maxnoimprove, double eps
   int noimprove = 0;
   while (iter < maxiter && !converged) {
 
-    // give items to random person
-    arma::ivec alloctemp = random_alloc(n_items, n_persons);
-    arma::mat valmattemp = get_valmat(vals, alloctemp, n_items, n_persons);
-    double soctemp = get_fnV(valmattemp, n_persons, avgval);
-    socvec(iter) = soctemp;
+    // give items to random person, or reassign walk random items of the previous sample - moving
+    // item v from set a to set b changes the sum of squared deviations by 2 * sum(v % (b - a + v))
+    if (walk == 0 || iter == 0) {
+      alloctemp = Owners(random_alloc(n_items, n_persons), n_persons);
+      valmattemp = get_valmat(vals, alloctemp, n_items, n_persons);
+      soctemp = get_fnV(valmattemp, n_persons, avgval);
+    } else {
+      for (int kk = 0; kk < walk; kk++) {
+        int item = arma::randi(1, arma::distr_param(0, n_items - 1))(0);
+        int addperson = arma::randi(1, arma::distr_param(1, n_persons - 1))(0);
+        int oldperson = alloctemp(item);
+        int newperson = (oldperson + addperson) % n_persons;
+        const double* v = vals.colptr(item);
+        const double* a = valmattemp.colptr(oldperson);
+        const double* b = valmattemp.colptr(newperson);
+        double delta = 0.0;
+        for (int ii = 0; ii < n_persons; ii++) delta += v[ii] * (b[ii] - a[ii] + v[ii]);
+        soctemp += 2.0 * delta / nn;
+        move_item_comp<0>(valmattemp, valcomp, vals, item, oldperson, newperson, n_persons);
+        alloctemp.set(item, newperson);
+        moved.add(item, n_items);
+      }
+      if (iter % resync_every == 0) {
+        if (get_drift(valmattemp, totals, scale)) {
+          valmattemp = get_valmat(vals, alloctemp, n_items, n_persons);
+          valcomp.zeros();
+        }
+        soctemp = get_fnV(valmattemp, n_persons, avgval);
+      }
+    }
+    socvec.set(iter, soctemp);
 
-    // update optimal solution
-    if (soctemp < minsoc) {
+    // update optimal solution - an independent sample is not needed anymore, a walk only updates
+    // the items it reassigned since the last improvement, the first sample is always kept
+    if (iter == 0 || soctemp < minsoc) {
       minsoc = soctemp;
-      alloc = alloctemp;
-      valmat = valmattemp;
+      if (walk == 0) {
+        std::swap(alloc, alloctemp);
+      } else {
+        moved.apply(alloc, alloctemp);
+      }
       noimprove = 0;
     } else {
       noimprove++;
@@ -159,6 +335,9 @@ List randselect_social(arma::mat vals, int maxiter, int maxnoimprove, double eps
     if (minsoc < eps) {
       converged = true;
       status = 0;
+    } else if (get_gap(minsoc, bound) < reltol) {
+      converged = true;
+      status = 4;
     } else if (noimprove >= maxnoimprove) {
       converged = true;
       status = 2;
@@ -168,12 +347,16 @@ List randselect_social(arma::mat vals, int maxiter, int maxnoimprove, double eps
   }
 
   List out;
-  out["alloc"] = alloc;
+  out["alloc"] = alloc.alloc();
   out["minsoc"] = minsoc;
-  out["valmat"] = valmat;
-  out["socvec"] = socvec;
+  if (!compact) {
+    out["valmat"] = get_valmat(vals, alloc, n_items, n_persons);
+    out["socvec"] = socvec.values;
+  }
   out["status"] = status;
   out["iter"] = iter;
+  out["bound"] = bound;
+  out["gap"] = get_gap(minsoc, bound);
 
   return out;
 }
@@ -0,0 +1,273 @@
+#include "RcppArmadillo.h"
+#include "helper.h"
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define FAIG_X86
+#include <immintrin.h>
+#endif
+
+
+// [[Rcpp::depends(RcppArmadillo)]]
+using namespace Rcpp;
+
+
+// Kernels on n x n column-major matrices (n x m for sumsqdev) for the objective functions. Each
+// one comes in a scalar version and, on x86 with gcc or clang, in SSE2, AVX2 and AVX-512 versions
+// that are compiled through target attributes and selected at load time from the features of the
+// cpu.
+
+
+double maxenvy_scalar(const double* valmat, const double* diag, int n) {
+  double m = 0.0;
+  for (int jj = 0; jj < n; jj++) {
+    const double* col = valmat + (size_t) jj * n;
+    for (int ii = 0; ii < n; ii++) m = std::max(m, col[ii] - diag[ii]);
+  }
+  return m;
+}
+
+
+double sumsqdev_scalar(const double* valmat, const double* avg, int n, int m) {
+  double s = 0.0;
+  for (int jj = 0; jj < m; jj++) {
+    const double* col = valmat + (size_t) jj * n;
+    for (int ii = 0; ii < n; ii++) {
+      double d = col[ii] - avg[ii];
+      s += d * d;
+    }
+  }
+  return s;
+}
+
+
+void addcol_scalar(double* y, const double* x, int n) {
+  for (int ii = 0; ii < n; ii++) y[ii] += x[ii];
+}
+
+
+#ifdef FAIG_X86
+
+__attribute__((target("sse2")))
+double maxenvy_sse2(const double* valmat, const double* diag, int n) {
+  __m128d vm = _mm_setzero_pd();
+  double m = 0.0;
+  for (int jj = 0; jj < n; jj++) {
+    const double* col = valmat + (size_t) jj * n;
+    int ii = 0;
+    for (; ii + 2 <= n; ii += 2) {
+      vm = _mm_max_pd(vm, _mm_sub_pd(_mm_loadu_pd(col + ii), _mm_loadu_pd(diag + ii)));
+    }
+    for (; ii < n; ii++) m = std::max(m, col[ii] - diag[ii]);
+  }
+  double buf[2];
+  _mm_storeu_pd(buf, vm);
+  return std::max(m, std::max(buf[0], buf[1]));
+}
+
+
+__attribute__((target("sse2")))
+double sumsqdev_sse2(const double* valmat, const double* avg, int n, int m) {
+  __m128d vs = _mm_setzero_pd();
+  double s = 0.0;
+  for (int jj = 0; jj < m; jj++) {
+    const double* col = valmat + (size_t) jj * n;
+    int ii = 0;
+    for (; ii + 2 <= n; ii += 2) {
+      __m128d d = _mm_sub_pd(_mm_loadu_pd(col + ii), _mm_loadu_pd(avg + ii));
+      vs = _mm_add_pd(vs, _mm_mul_pd(d, d));
+    }
+    for (; ii < n; ii++) {
+      double d = col[ii] - avg[ii];
+      s += d * d;
+    }
+  }
+  double buf[2];
+  _mm_storeu_pd(buf, vs);
+  return s + buf[0] + buf[1];
+}
+
+
+__attribute__((target("sse2")))
+void addcol_sse2(double* y, const double* x, int n) {
+  int ii = 0;
+  for (; ii + 2 <= n; ii += 2) {
+    _mm_storeu_pd(y + ii, _mm_add_pd(_mm_loadu_pd(y + ii), _mm_loadu_pd(x + ii)));
+  }
+  for (; ii < n; ii++) y[ii] += x[ii];
+}
+
+
+__attribute__((target("avx2")))
+double maxenvy_avx2(const double* valmat, const double* diag, int n) {
+  __m256d vm = _mm256_setzero_pd();
+  double m = 0.0;
+  for (int jj = 0; jj < n; jj++) {
+    const double* col = valmat + (size_t) jj * n;
+    int ii = 0;
+    for (; ii + 4 <= n; ii += 4) {
+      vm = _mm256_max_pd(vm, _mm256_sub_pd(_mm256_loadu_pd(col + ii), _mm256_loadu_pd(diag + ii)));
+    }
+    for (; ii < n; ii++) m = std::max(m, col[ii] - diag[ii]);
+  }
+  double buf[4];
+  _mm256_storeu_pd(buf, vm);
+  for (int kk = 0; kk < 4; kk++) m = std::max(m, buf[kk]);
+  return m;
+}
+
+
+__attribute__((target("avx2")))
+double sumsqdev_avx2(const double* valmat, const double* avg, int n, int m) {
+  __m256d vs = _mm256_setzero_pd();
+  double s = 0.0;
+  for (int jj = 0; jj < m; jj++) {
+    const double* col = valmat + (size_t) jj * n;
+    int ii = 0;
+    for (; ii + 4 <= n; ii += 4) {
+      __m256d d = _mm256_sub_pd(_mm256_loadu_pd(col + ii), _mm256_loadu_pd(avg + ii));
+      vs = _mm256_add_pd(vs, _mm256_mul_pd(d, d));
+    }
+    for (; ii < n; ii++) {
+      double d = col[ii] - avg[ii];
+      s += d * d;
+    }
+  }
+  double buf[4];
+  _mm256_storeu_pd(buf, vs);
+  return s + buf[0] + buf[1] + buf[2] + buf[3];
+}
+
+
+__attribute__((target("avx2")))
+void addcol_avx2(double* y, const double* x, int n) {
+  int ii = 0;
+  for (; ii + 4 <= n; ii += 4) {
+    _mm256_storeu_pd(y + ii, _mm256_add_pd(_mm256_loadu_pd(y + ii), _mm256_loadu_pd(x + ii)));
+  }
+  for (; ii < n; ii++) y[ii] += x[ii];
+}
+
+
+__attribute__((target("avx512f")))
+double maxenvy_avx512(const double* valmat, const double* diag, int n) {
+  __m512d vm = _mm512_setzero_pd();
+  double m = 0.0;
+  for (int jj = 0; jj < n; jj++) {
+    const double* col = valmat + (size_t) jj * n;
+    int ii = 0;
+    for (; ii + 8 <= n; ii += 8) {
+      vm = _mm512_max_pd(vm, _mm512_sub_pd(_mm512_loadu_pd(col + ii), _mm512_loadu_pd(diag + ii)));
+    }
+    for (; ii < n; ii++) m = std::max(m, col[ii] - diag[ii]);
+  }
+  double buf[8];
+  _mm512_storeu_pd(buf, vm);
+  for (int kk = 0; kk < 8; kk++) m = std::max(m, buf[kk]);
+  return m;
+}
+
+
+__attribute__((target("avx512f")))
+double sumsqdev_avx512(const double* valmat, const double* avg, int n, int m) {
+  __m512d vs = _mm512_setzero_pd();
+  double s = 0.0;
+  for (int jj = 0; jj < m; jj++) {
+    const double* col = valmat + (size_t) jj * n;
+    int ii = 0;
+    for (; ii + 8 <= n; ii += 8) {
+      __m512d d = _mm512_sub_pd(_mm512_loadu_pd(col + ii), _mm512_loadu_pd(avg + ii));
+      vs = _mm512_add_pd(vs, _mm512_mul_pd(d, d));
+    }
+    for (; ii < n; ii++) {
+      double d = col[ii] - avg[ii];
+      s += d * d;
+    }
+  }
+  double buf[8];
+  _mm512_storeu_pd(buf, vs);
+  for (int kk = 0; kk < 8; kk++) s += buf[kk];
+  return s;
+}
+
+
+__attribute__((target("avx512f")))
+void addcol_avx512(double* y, const double* x, int n) {
+  int ii = 0;
+  for (; ii + 8 <= n; ii += 8) {
+    _mm512_storeu_pd(y + ii, _mm512_add_pd(_mm512_loadu_pd(y + ii), _mm512_loadu_pd(x + ii)));
+  }
+  for (; ii < n; ii++) y[ii] += x[ii];
+}
+
+#endif
+
+
+struct Kernels {
+  // set of kernels of one instruction set
+  const char* name;
+  double (*maxenvy)(const double*, const double*, int);
+  double (*sumsqdev)(const double*, const double*, int, int);
+  void (*addcol)(double*, const double*, int);
+};
+
+
+Kernels get_kernels(int level) {
+  // kernels for the requested level: 0 (scalar), 1 (SSE2), 2 (AVX2), 3 (AVX-512) or -1 (the best
+  // level supported by the cpu); levels that are not supported fall back to the next lower one
+#ifdef FAIG_X86
+  __builtin_cpu_init();
+  if (level < 0 || level > 3) level = 3;
+  if (level >= 3 && __builtin_cpu_supports("avx512f")) {
+    Kernels k = {"avx512", maxenvy_avx512, sumsqdev_avx512, addcol_avx512};
+    return k;
+  }
+  if (level >= 2 && __builtin_cpu_supports("avx2")) {
+    Kernels k = {"avx2", maxenvy_avx2, sumsqdev_avx2, addcol_avx2};
+    return k;
+  }
+  if (level >= 1 && __builtin_cpu_supports("sse2")) {
+    Kernels k = {"sse2", maxenvy_sse2, sumsqdev_sse2, addcol_sse2};
+    return k;
+  }
+#endif
+  Kernels k = {"scalar", maxenvy_scalar, sumsqdev_scalar, addcol_scalar};
+  return k;
+}
+
+
+static Kernels kernels = get_kernels(-1);
+
+
+double simd_maxenvy(const double* valmat, const double* diag, int n) {
+  // maximum over all elements of valmat(i, j) - diag(i), and zero
+  return kernels.maxenvy(valmat, diag, n);
+}
+
+
+double simd_sumsqdev(const double* valmat, const double* avg, int n, int m) {
+  // sum over all elements of (valmat(i, j) - avg(i))^2 for n x m valmat
+  return kernels.sumsqdev(valmat, avg, n, m);
+}
+
+
+void simd_addcol(double* y, const double* x, int n) {
+  // y += x for vectors of length n
+  kernels.addcol(y, x, n);
+}
+
+
+// [[Rcpp::export]]
+std::string simd_level(int level) {
+  // selects the kernels used by get_valmat, get_maxenvy and get_fnV, mainly to compare them with the
+  // scalar versions
+  //
+  // arguments:
+  // level    : 0 (scalar), 1 (SSE2), 2 (AVX2), 3 (AVX-512) or -1 (best supported by the cpu)
+  //
+  // output:
+  // name     : name of the selected kernels
+  //
+  // author: Dries Cornilly
+
+  kernels = get_kernels(level);
+  return kernels.name;
+}